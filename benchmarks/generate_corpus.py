@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+
+# Copyright 2018 Adobe
+# All Rights Reserved.
+
+# NOTICE: Adobe permits you to use, modify, and distribute this file in
+# accordance with the terms of the Adobe license agreement accompanying
+# it. If you have received this file from a source other than Adobe,
+# then your use, modification, or distribution of it requires the prior
+# written permission of Adobe.
+
+"""Generates a corpus of synthetic headers for benchmarking hyde at scale.
+
+Every header is self-contained (it includes nothing, not even the standard library), so hyde can
+process it without any toolchain autodetection. The output is deterministic for a given set of
+parameters.
+"""
+
+import argparse
+import os
+import random
+
+#---------------------------------------------------------------------------------------------------
+
+COPYRIGHT = """/*
+Synthetic header generated by benchmarks/generate_corpus.py. Do not edit.
+*/
+"""
+
+#---------------------------------------------------------------------------------------------------
+
+def doxygen(rng, indent, brief, params=(), returns=None, lines=0, owner=None):
+    """A doxygen comment block, padded with `lines` lines of descriptive text."""
+    words = ["the", "value", "range", "iterator", "allocator", "element", "sequence", "container",
+             "invariant", "complexity", "amortized", "constant", "linear", "precondition",
+             "postcondition", "throws", "strong", "guarantee", "ownership", "lifetime"]
+    result = [f"{indent}/// @brief {brief}"]
+    for _ in range(lines):
+        result.append(f"{indent}/// " + " ".join(rng.choice(words) for _ in range(12)) + ".")
+    for param in params:
+        result.append(f"{indent}/// @param {param} the `{param}` argument; " +
+                      " ".join(rng.choice(words) for _ in range(6)) + ".")
+    if returns:
+        result.append(f"{indent}/// @return {returns}")
+    if owner:
+        result.append(f"{indent}/// @hyde-owner {owner}")
+    return result
+
+#---------------------------------------------------------------------------------------------------
+
+def nested_type(depth, leaf):
+    """`wrap<wrap<...<leaf>...>>`, `depth` levels deep."""
+    result = leaf
+    for _ in range(depth):
+        result = f"wrap<{result}>"
+    return result
+
+#---------------------------------------------------------------------------------------------------
+
+def emit_enum(rng, out, indent, name, size, args):
+    out.extend(doxygen(rng, indent, f"an enumeration of {size} values.", lines=args.comment_lines,
+                       owner="bench"))
+    out.append(f"{indent}enum class {name} {{")
+    for i in range(size):
+        out.extend(doxygen(rng, indent + "    ", f"enumerator {i}."))
+        out.append(f"{indent}    {name}_value_{i} = {i},")
+    out.append(f"{indent}}};")
+    out.append("")
+
+#---------------------------------------------------------------------------------------------------
+
+def emit_class(rng, out, indent, name, args):
+    out.extend(doxygen(rng, indent, f"the class `{name}`.", lines=args.comment_lines,
+                       owner="bench"))
+    out.append(f"{indent}template <class T, class U = int>")
+    out.append(f"{indent}class {name} {{")
+    out.append(f"{indent}public:")
+    inner = indent + "    "
+
+    out.extend(doxygen(rng, inner, "the value type."))
+    out.append(f"{inner}using value_type = {nested_type(args.template_depth, 'T')};")
+    out.append("")
+
+    out.extend(doxygen(rng, inner, "default constructor."))
+    out.append(f"{inner}{name}();")
+    out.append("")
+
+    for m in range(args.methods):
+        for k in range(args.overloads):
+            params = [f"arg{p}" for p in range(k + 1)]
+            types = [nested_type((p + m) % (args.template_depth + 1), "U") if p % 2 else
+                     "const value_type&" for p in range(k + 1)]
+            signature = ", ".join(f"{t} {p}" for t, p in zip(types, params))
+            out.extend(doxygen(rng, inner, f"method {m}, overload {k}.", params=params,
+                               returns="the result.", lines=args.comment_lines))
+            qualifiers = " const" if (m + k) % 3 == 0 else ""
+            out.append(f"{inner}{nested_type(m % (args.template_depth + 1), 'T')} "
+                       f"method_{m}({signature}){qualifiers};")
+            out.append("")
+
+    out.extend(doxygen(rng, inner, "a static data member."))
+    out.append(f"{inner}static const int static_member_{name} = 0;")
+    out.append(f"{indent}}};")
+    out.append("")
+
+#---------------------------------------------------------------------------------------------------
+
+def emit_free_functions(rng, out, indent, args):
+    for f in range(args.functions):
+        for k in range(args.overloads):
+            params = [f"arg{p}" for p in range(k + 1)]
+            signature = ", ".join(f"{nested_type(p % (args.template_depth + 1), 'T')} {n}"
+                                  for p, n in enumerate(params))
+            out.extend(doxygen(rng, indent, f"free function {f}, overload {k}.", params=params,
+                               returns="the result.", lines=args.comment_lines, owner="bench"))
+            out.append(f"{indent}template <class T>")
+            out.append(f"{indent}T function_{f}({signature});")
+            out.append("")
+
+#---------------------------------------------------------------------------------------------------
+
+def emit_header(index, args):
+    rng = random.Random(args.seed * 1000003 + index)
+    out = [COPYRIGHT, "#pragma once", ""]
+
+    # A template used to build deeply nested types, and deep template nesting in its own right.
+    out.append("/// @brief a wrapper used to nest template types.")
+    out.append("template <class T>")
+    out.append("struct wrap {")
+    out.append("    /// @brief the wrapped value.")
+    out.append("    T value;")
+    out.append("};")
+    out.append("")
+
+    for n in range(args.namespaces):
+        indent = ""
+        for depth in range(args.namespace_depth):
+            out.append(f"{indent}namespace bench_{index}_ns_{n}_{depth} {{")
+            indent += "    "
+        out.append("")
+
+        for c in range(args.classes):
+            emit_class(rng, out, indent, f"class_{c}", args)
+
+        for e in range(args.enums):
+            emit_enum(rng, out, indent, f"enum_{e}", args.enum_size, args)
+
+        emit_free_functions(rng, out, indent, args)
+
+        for depth in reversed(range(args.namespace_depth)):
+            indent = indent[:-4]
+            out.append(f"{indent}}} // namespace bench_{index}_ns_{n}_{depth}")
+        out.append("")
+
+    return "\n".join(out) + "\n"
+
+#---------------------------------------------------------------------------------------------------
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("output", help="directory to write the headers into")
+    parser.add_argument("--headers", type=int, default=8, help="number of headers")
+    parser.add_argument("--namespaces", type=int, default=2, help="namespaces per header")
+    parser.add_argument("--namespace-depth", type=int, default=2, help="nesting of namespaces")
+    parser.add_argument("--classes", type=int, default=8, help="classes per namespace")
+    parser.add_argument("--methods", type=int, default=8, help="methods per class")
+    parser.add_argument("--overloads", type=int, default=3, help="overloads per method/function")
+    parser.add_argument("--functions", type=int, default=8, help="free functions per namespace")
+    parser.add_argument("--template-depth", type=int, default=4, help="template nesting depth")
+    parser.add_argument("--enums", type=int, default=2, help="enums per namespace")
+    parser.add_argument("--enum-size", type=int, default=64, help="enumerators per enum")
+    parser.add_argument("--comment-lines", type=int, default=4,
+                        help="lines of descriptive text per doxygen comment")
+    parser.add_argument("--seed", type=int, default=42, help="seed for the comment text")
+    args = parser.parse_args()
+
+    os.makedirs(args.output, exist_ok=True)
+
+    for index in range(args.headers):
+        path = os.path.join(args.output, f"bench_{index}.hpp")
+        contents = emit_header(index, args)
+
+        # Leave unchanged headers alone, so their timestamps do not change from run to run.
+        if os.path.exists(path):
+            with open(path, encoding="utf-8") as f:
+                if f.read() == contents:
+                    continue
+
+        with open(path, "w", encoding="utf-8") as f:
+            f.write(contents)
+
+#---------------------------------------------------------------------------------------------------
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,491 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+// stdc++
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// diff
+#include "diff/myers.hpp"
+
+// yaml-cpp
+#include "yaml-cpp/yaml.h"
+
+// application
+#include "emitters/yaml_base_emitter.hpp"
+#include "json.hpp"
+#include "matchers/utilities.hpp"
+
+/**************************************************************************************************/
+// Every allocation made by the process is counted, so each kernel can be charged for its own. The
+// replacements are kept out of line so the compiler cannot see `free` paired with `new`.
+
+namespace {
+
+std::size_t allocations_s{0};
+
+} // namespace
+
+[[gnu::noinline]] void* operator new(std::size_t size) {
+    ++allocations_s;
+    if (void* result = std::malloc(size ? size : 1)) return result;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void* operator new[](std::size_t size) { return operator new(size); }
+
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete[](void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+/**************************************************************************************************/
+
+namespace {
+
+/**************************************************************************************************/
+
+// Exposes the per-symbol kernels of the emitter base, which has no state they depend upon.
+struct kernel_emitter : public hyde::yaml_base_emitter {
+    kernel_emitter() : yaml_base_emitter(".", ".", hyde::yaml_mode::validate, hyde::emit_options()) {}
+
+    bool emit(const hyde::json&, hyde::json&, const hyde::json&) override { return false; }
+
+    using yaml_base_emitter::directory_mangle;
+    using yaml_base_emitter::filename_filter;
+    using yaml_base_emitter::filename_truncate;
+    using yaml_base_emitter::format_template_parameters;
+
+protected:
+    bool do_merge(const std::string&, const hyde::json&, const hyde::json&, hyde::json&) override {
+        return false;
+    }
+};
+
+/**************************************************************************************************/
+
+// Inputs to the kernels, taken from the pages under docs/libraries.
+struct corpus {
+    std::vector<YAML::Node> _yaml;                    // front matter of each page
+    std::vector<hyde::json> _json;                    // the same, as JSON
+    std::vector<std::string> _names;                  // titles, fields, and overload keys
+    std::vector<std::filesystem::path> _paths;        // directories the pages live in
+    std::vector<std::string> _signatures;             // overload keys and declarations
+    std::vector<std::string> _spaced;                 // signatures with their `>>` as `> >`
+    std::vector<hyde::json> _templates;               // pages' template parameters
+    std::vector<std::string> _type_parameters;        // signatures in `type-parameter-N-M` form
+    std::vector<std::vector<std::pair<std::string, std::string>>> _parameters; // ...and their names
+    std::vector<std::pair<std::string, std::string>> _pairs; // overload keys of the same page
+};
+
+/**************************************************************************************************/
+
+std::string front_matter(const std::filesystem::path& path) {
+    std::ifstream input(path);
+    std::stringstream stream;
+    stream << input.rdbuf();
+    const std::string contents = stream.str();
+
+    if (contents.rfind("---\n", 0) != 0) return std::string();
+    const auto end = contents.find("\n---", 3);
+    if (end == std::string::npos) return std::string();
+    return contents.substr(4, end - 3);
+}
+
+/**************************************************************************************************/
+
+// Splits the parameters of `template <...>` at the start of `declaration` into their types and
+// names, in the shape the class matcher gives them to `format_template_parameters`.
+hyde::json parse_template_parameters(const std::string& declaration) {
+    if (declaration.rfind("template <", 0) != 0) return hyde::json::object();
+
+    hyde::json parameters = hyde::json::array();
+    std::size_t depth{0};
+    std::string current;
+
+    const auto flush = [&]() {
+        const auto last_space = current.find_last_of(' ');
+        if (last_space == std::string::npos) return;
+        hyde::json parameter = hyde::json::object();
+        std::string type = current.substr(0, last_space);
+        if (type.size() > 3 && type.compare(type.size() - 3, 3, "...") == 0) {
+            type.resize(type.size() - 3);
+            parameter["parameter_pack"] = "true";
+        }
+        parameter["type"] = std::move(type);
+        parameter["name"] = current.substr(last_space + 1);
+        parameters.push_back(std::move(parameter));
+        current.clear();
+    };
+
+    for (std::size_t i = std::string_view("template <").size(); i < declaration.size(); ++i) {
+        const char c = declaration[i];
+        if (c == '<') {
+            ++depth;
+        } else if (c == '>') {
+            if (!depth) break;
+            --depth;
+        } else if (c == ',' && !depth) {
+            flush();
+            while (i + 1 < declaration.size() && declaration[i + 1] == ' ')
+                ++i;
+            continue;
+        }
+        current += c;
+    }
+    flush();
+
+    hyde::json result = hyde::json::object();
+    result["template_parameters"] = std::move(parameters);
+    return result;
+}
+
+/**************************************************************************************************/
+
+// Rewrites each template parameter name in `signature` the way clang spells a dependent type it
+// cannot name (`type-parameter-0-N`), returning the mapping back.
+std::pair<std::string, std::vector<std::pair<std::string, std::string>>> hide_type_parameters(
+    const std::string& signature, const hyde::json& templates) {
+    std::vector<std::pair<std::string, std::string>> parameters;
+    std::string result;
+
+    if (templates.count("template_parameters")) {
+        std::size_t index{0};
+        for (const auto& parameter : templates["template_parameters"]) {
+            parameters.emplace_back("type-parameter-0-" + std::to_string(index++),
+                                    static_cast<const std::string&>(parameter["name"]));
+        }
+    }
+
+    const auto is_identifier = [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    };
+
+    for (std::size_t i = 0; i < signature.size();) {
+        if (!is_identifier(signature[i])) {
+            result += signature[i++];
+            continue;
+        }
+        std::size_t end = i;
+        while (end < signature.size() && is_identifier(signature[end]))
+            ++end;
+        std::string token = signature.substr(i, end - i);
+        for (const auto& [hidden, name] : parameters) {
+            if (token == name) {
+                token = hidden;
+                break;
+            }
+        }
+        result += token;
+        i = end;
+    }
+
+    return std::make_pair(std::move(result), std::move(parameters));
+}
+
+/**************************************************************************************************/
+
+bool load_corpus(const std::filesystem::path& root, corpus& out) {
+    std::error_code ec;
+
+    for (std::filesystem::recursive_directory_iterator iter(root, ec), last; !ec && iter != last;
+         iter.increment(ec)) {
+        const auto& path = iter->path();
+        if (path.extension() != ".md") continue;
+
+        const std::string yaml_text = front_matter(path);
+        if (yaml_text.empty()) continue;
+
+        YAML::Node yaml;
+        try {
+            yaml = YAML::Load(yaml_text);
+        } catch (...) {
+            std::cerr << "./" << path.string() << ": could not parse front matter\n";
+            continue;
+        }
+
+        hyde::json json = hyde::yaml_to_json(yaml);
+        out._paths.push_back(std::filesystem::relative(path.parent_path(), root));
+
+        if (json.count("title")) out._names.push_back(json["title"]);
+
+        const hyde::json page = json.count("hyde") ? json["hyde"] : hyde::json::object();
+        const std::string declaration =
+            page.count("declaration") ? static_cast<const std::string&>(page["declaration"]) : "";
+        hyde::json templates = parse_template_parameters(declaration);
+
+        std::vector<std::string> signatures;
+        if (!declaration.empty()) signatures.push_back(declaration);
+        if (page.count("fields")) {
+            for (const auto& field : page["fields"].items()) {
+                out._names.push_back(field.key());
+            }
+        }
+        if (page.count("overloads")) {
+            std::vector<std::string> keys;
+            for (const auto& overload : page["overloads"].items()) {
+                keys.push_back(overload.key());
+                if (overload.value().count("signature_with_names")) {
+                    signatures.push_back(overload.value()["signature_with_names"]);
+                }
+            }
+            for (std::size_t i = 0; i < keys.size(); ++i) {
+                for (std::size_t j = i + 1; j < keys.size(); ++j) {
+                    out._pairs.emplace_back(keys[i], keys[j]);
+                }
+            }
+            out._names.insert(out._names.end(), keys.begin(), keys.end());
+            signatures.insert(signatures.end(), keys.begin(), keys.end());
+        }
+
+        for (auto& signature : signatures) {
+            auto [hidden, parameters] = hide_type_parameters(signature, templates);
+            out._type_parameters.push_back(std::move(hidden));
+            out._parameters.push_back(std::move(parameters));
+            out._spaced.push_back(hyde::ReplaceAll(signature, ">>", "> >"));
+            out._signatures.push_back(std::move(signature));
+        }
+
+        if (!templates.empty()) out._templates.push_back(std::move(templates));
+        out._yaml.push_back(std::move(yaml));
+        out._json.push_back(std::move(json));
+    }
+
+    if (ec) {
+        std::cerr << "./" << root.string() << ": " << ec.message() << '\n';
+        return true;
+    }
+
+    return false;
+}
+
+/**************************************************************************************************/
+
+// diff_score is documented as the insert/delete edit distance, which is what it measured when it
+// was computed from a Myers diff. Hold the faster kernel to that.
+bool verify_diff_score(const corpus& c) {
+    bool failure{false};
+
+    const auto myers_score = [](std::string_view src, std::string_view dst) {
+        std::size_t score{0};
+        for (const auto& op : myers::diff(src, dst)) {
+            if (op.operation != myers::operation::cpy) score += op.text.size();
+        }
+        return score;
+    };
+
+    const auto check = [&](const std::string& src, const std::string& dst) {
+        const std::size_t expected = myers_score(src, dst);
+        const std::size_t actual = hyde::diff_score(src, dst);
+        if (actual == expected) return;
+        std::cerr << "diff_score(\"" << src << "\", \"" << dst << "\") is " << actual
+                  << ", expected " << expected << '\n';
+        failure = true;
+    };
+
+    for (const auto& [src, dst] : c._pairs) {
+        check(src, dst);
+    }
+    for (std::size_t i = 1; i < c._signatures.size(); ++i) {
+        check(c._signatures[i - 1], c._signatures[i]);
+    }
+
+    return failure;
+}
+
+/**************************************************************************************************/
+
+// The signatures of docs/libraries fit in a word or two. Hold the kernel to the textbook dynamic
+// program over random pairs, too, of lengths up to and across several word boundaries (where the
+// carry from one word to the next comes into play), over alphabets small enough that most
+// characters match something.
+bool verify_diff_score_random() {
+    bool failure{false};
+
+    const auto reference_score = [](std::string_view src, std::string_view dst) {
+        std::vector<std::size_t> row(dst.size() + 1, 0);
+        for (const auto& c : src) {
+            std::size_t diagonal{0};
+            for (std::size_t j = 0; j < dst.size(); ++j) {
+                const std::size_t above = row[j + 1];
+                row[j + 1] = c == dst[j] ? diagonal + 1 : std::max(above, row[j]);
+                diagonal = above;
+            }
+        }
+        return src.size() + dst.size() - 2 * row.back();
+    };
+
+    std::mt19937 engine(20181101); // fixed, so a failure can be reproduced
+    const std::size_t lengths[] = {0, 1, 2, 31, 63, 64, 65, 127, 128, 129, 191, 192, 193, 300};
+    const auto random_string = [&](std::size_t size, char alphabet) {
+        std::uniform_int_distribution<int> character(0, alphabet - 1);
+        std::string result(size, ' ');
+        for (auto& c : result)
+            c = static_cast<char>('a' + character(engine));
+        return result;
+    };
+
+    std::uniform_int_distribution<std::size_t> random_length(0, 300);
+    std::uniform_int_distribution<int> random_alphabet(1, 26);
+
+    for (std::size_t i = 0; i < 20000 && !failure; ++i) {
+        // Every pair of the lengths above first, then random ones.
+        const std::size_t n = std::size(lengths);
+        const bool fixed = i < n * n;
+        const std::size_t src_size = fixed ? lengths[i / n] : random_length(engine);
+        const std::size_t dst_size = fixed ? lengths[i % n] : random_length(engine);
+        const char alphabet = static_cast<char>(random_alphabet(engine));
+        const std::string src = random_string(src_size, alphabet);
+        const std::string dst = random_string(dst_size, alphabet);
+
+        // Bounds well under the score, where the rows stop early, as well as either side of it.
+        const std::size_t expected = reference_score(src, dst);
+        const std::size_t bounds[] = {expected / 2, expected ? expected - 1 : 0, expected,
+                                      expected + 1};
+        const std::size_t bound = bounds[i % std::size(bounds)];
+
+        if (hyde::diff_score(src, dst) != expected ||
+            hyde::diff_score(src, dst, bound) != std::min(expected, bound + 1)) {
+            std::cerr << "diff_score(\"" << src << "\", \"" << dst
+                      << "\") differs from the reference score of " << expected << '\n';
+            failure = true;
+        }
+    }
+
+    return failure;
+}
+
+/**************************************************************************************************/
+
+volatile std::size_t sink_s;
+
+// Runs `op` over `count` inputs, repeatedly, until `min_time` has passed, and reports the time and
+// allocations per call.
+template <typename Op>
+void measure(const char* name, std::size_t count, std::chrono::nanoseconds min_time, Op op) {
+    if (!count) {
+        std::cout << std::left << std::setw(28) << name << "(no inputs)\n";
+        return;
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+        sink_s = sink_s + op(i); // warm up
+
+    using clock = std::chrono::steady_clock;
+    std::size_t ops{0};
+    const std::size_t allocations_start = allocations_s;
+    const auto start = clock::now();
+    auto elapsed = clock::duration::zero();
+
+    do {
+        for (std::size_t i = 0; i < count; ++i)
+            sink_s = sink_s + op(i);
+        ops += count;
+        elapsed = clock::now() - start;
+    } while (elapsed < min_time);
+
+    const std::size_t allocations = allocations_s - allocations_start;
+    const double ns =
+        std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(elapsed).count();
+
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(12) << ns / ops << std::setw(14)
+              << static_cast<double>(allocations) / ops << std::setw(12) << count << '\n';
+}
+
+/**************************************************************************************************/
+
+} // namespace
+
+/**************************************************************************************************/
+
+int main(int argc, char** argv) try {
+#ifdef HYDE_DOCS_LIBRARIES_DIR
+    std::filesystem::path root(HYDE_DOCS_LIBRARIES_DIR);
+#else
+    std::filesystem::path root("docs/libraries");
+#endif
+    std::chrono::milliseconds min_time(200);
+    bool verify_only{false};
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        if (arg == "--verify-only") {
+            verify_only = true;
+        } else if (arg.rfind("--min-time-ms=", 0) == 0) {
+            min_time = std::chrono::milliseconds(std::atoi(argv[i] + arg.find('=') + 1));
+        } else {
+            root = arg;
+        }
+    }
+
+    corpus c;
+    if (load_corpus(root, c)) return EXIT_FAILURE;
+    if (verify_diff_score(c) || verify_diff_score_random()) return EXIT_FAILURE;
+    if (verify_only) return EXIT_SUCCESS;
+
+    kernel_emitter emitter;
+
+    std::cout << std::left << std::setw(28) << "kernel" << std::right << std::setw(12) << "ns/op"
+              << std::setw(14) << "allocs/op" << std::setw(12) << "inputs" << '\n';
+
+    measure("filename_filter", c._names.size(), min_time,
+            [&](std::size_t i) { return emitter.filename_filter(c._names[i]).size(); });
+    measure("filename_truncate", c._signatures.size(), min_time,
+            [&](std::size_t i) { return emitter.filename_truncate(c._signatures[i]).size(); });
+    measure("fnv_1a", c._signatures.size(), min_time,
+            [&](std::size_t i) { return static_cast<std::size_t>(hyde::fnv_1a(c._signatures[i])); });
+    measure("directory_mangle", c._paths.size(), min_time, [&](std::size_t i) {
+        return emitter.directory_mangle(c._paths[i]).native().size();
+    });
+    measure("ReplaceAll", c._signatures.size(), min_time, [&](std::size_t i) {
+        return hyde::ReplaceAll(c._signatures[i], "\n", "\\n").size();
+    });
+    measure("PostProcessSpacing", c._spaced.size(), min_time,
+            [&](std::size_t i) { return hyde::PostProcessSpacing(c._spaced[i]).size(); });
+    measure("ResolveTypeParameters", c._type_parameters.size(), min_time, [&](std::size_t i) {
+        return hyde::ResolveTypeParameters(c._type_parameters[i], c._parameters[i]).size();
+    });
+    measure("diff_score", c._pairs.size(), min_time, [&](std::size_t i) {
+        return hyde::diff_score(c._pairs[i].first, c._pairs[i].second);
+    });
+    measure("format_template_parameters", c._templates.size(), min_time, [&](std::size_t i) {
+        return emitter.format_template_parameters(c._templates[i], true).size();
+    });
+    measure("json_to_yaml_ordered", c._json.size(), min_time,
+            [&](std::size_t i) { return hyde::json_to_yaml_ordered(c._json[i]).size(); });
+    measure("yaml_to_json", c._yaml.size(), min_time,
+            [&](std::size_t i) { return hyde::yaml_to_json(c._yaml[i]).size(); });
+
+    return EXIT_SUCCESS;
+} catch (const std::exception& error) {
+    std::cerr << "Fatal error: " << error.what() << '\n';
+    return EXIT_FAILURE;
+} catch (...) {
+    std::cerr << "Fatal error: unknown\n";
+    return EXIT_FAILURE;
+}
+
+/**************************************************************************************************/
@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+
+# Copyright 2018 Adobe
+# All Rights Reserved.
+
+# NOTICE: Adobe permits you to use, modify, and distribute this file in
+# accordance with the terms of the Adobe license agreement accompanying
+# it. If you have received this file from a source other than Adobe,
+# then your use, modification, or distribution of it requires the prior
+# written permission of Adobe.
+
+"""Runs hyde over a header corpus in each of its modes and reports what every mode cost.
+
+hyde is run once per header, as a build would run it. The modes are run in the order a
+documentation workflow runs them:
+
+    update-create     `-hyde-update` into an empty YAML directory
+    validate          `-hyde-validate` against the YAML just created
+    update-unchanged  `-hyde-update` again, when no page needs writing
+    json              `-hyde-json`
+
+For each mode the report holds the wall time, the peak resident set size of the largest hyde
+process, hyde's own phase and matcher times (from `-hyde-stats`), and, when strace is available,
+the number of system calls made. Syscalls are counted in a separate pass so tracing does not skew
+the timings. They are totals for the whole mode (every hyde process it ran, from start to exit),
+not per phase: `strace -c` cannot attribute a call to one of hyde's phases, so compare them
+between modes and backends, not against the phase times.
+
+With `--cold-cache` (Linux only), `validate` and `update-unchanged` are then run again once per
+`-hyde-io` backend, with the YAML directory evicted from the page cache before every pass, as
+`validate-cold-<backend>` and `update-unchanged-cold-<backend>`.
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+#---------------------------------------------------------------------------------------------------
+
+MODES = [
+    ("update-create", "-hyde-update", True),
+    ("validate", "-hyde-validate", False),
+    ("update-unchanged", "-hyde-update", False),
+    ("json", "-hyde-json", False),
+]
+
+IO_BACKENDS = ["io_uring", "sync"]
+
+STRACE_TOTAL = re.compile(r"^\s*[\d.]+\s+[\d.]+\s+\d+\s+(\d+)\s+(?:\d+\s+)?total\s*$")
+STRACE_ROW = re.compile(r"^\s*[\d.]+\s+[\d.]+\s+\d+\s+(\d+)\s+(?:\d+\s+)?(\w+)\s*$")
+
+#---------------------------------------------------------------------------------------------------
+
+def hyde_command(args, mode_flag, header, yaml_dir, stats_path, io=None):
+    command = [args.hyde, mode_flag, f"-hyde-stats={stats_path}"]
+    if mode_flag != "-hyde-json":
+        command += [f"-hyde-src-root={args.corpus}", f"-hyde-yaml-dir={yaml_dir}"]
+    io = io or args.io
+    if io:
+        command += [f"-hyde-io={io}"]
+    command += [header, "--", "-x", "c++", f"-std={args.std}"]
+    return command
+
+#---------------------------------------------------------------------------------------------------
+
+def run_timed(command, stdout=subprocess.DEVNULL):
+    """Runs `command`, returning its exit code, wall time, peak RSS in bytes, and its errors."""
+    start = time.perf_counter()
+    process = subprocess.Popen(command, stdout=stdout, stderr=subprocess.PIPE)
+    stderr = process.stderr.read()
+    _, status, usage = os.wait4(process.pid, 0)
+    wall = time.perf_counter() - start
+    process.returncode = os.waitstatus_to_exitcode(status)
+    process.stderr.close()
+
+    # ru_maxrss is in kilobytes on Linux, but in bytes on macOS.
+    rss = usage.ru_maxrss if sys.platform == "darwin" else usage.ru_maxrss * 1024
+
+    return process.returncode, wall, rss, stderr.decode("utf-8", "replace")
+
+#---------------------------------------------------------------------------------------------------
+
+def evict_page_cache(directory):
+    """Evicts the files under `directory` from the page cache. Every cache is dropped if this is
+    permitted (i.e., as root); otherwise the kernel is advised that the files are not needed."""
+    os.sync()
+    try:
+        with open("/proc/sys/vm/drop_caches", "w", encoding="utf-8") as f:
+            f.write("3\n")
+        return
+    except OSError:
+        pass
+    for root, _, files in os.walk(directory):
+        for name in files:
+            fd = os.open(os.path.join(root, name), os.O_RDONLY)
+            try:
+                os.posix_fadvise(fd, 0, 0, os.POSIX_FADV_DONTNEED)
+            finally:
+                os.close(fd)
+
+#---------------------------------------------------------------------------------------------------
+
+def count_syscalls(command, scratch):
+    """Runs `command` under `strace -c`, returning the total and per-syscall call counts.
+
+    The counts cover the whole process tree of `command`; they are not split by phase.
+    """
+    output = os.path.join(scratch, "strace.txt")
+    subprocess.run(["strace", "-c", "-f", "-o", output] + command,
+                   stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    total = 0
+    calls = {}
+    with open(output, encoding="utf-8") as f:
+        for line in f:
+            match = STRACE_TOTAL.match(line)
+            if match:
+                total = int(match.group(1))
+                continue
+            match = STRACE_ROW.match(line)
+            if match:
+                calls[match.group(2)] = int(match.group(1))
+    return total, calls
+
+#---------------------------------------------------------------------------------------------------
+
+def accumulate_phases(into, stats):
+    for phase, time in stats.get("phases", {}).items():
+        entry = into.setdefault(phase, {"wall_seconds": 0, "user_seconds": 0,
+                                        "system_seconds": 0})
+        for key in entry:
+            entry[key] += time.get(key, 0)
+
+def accumulate_matchers(into, stats):
+    for matcher, counts in stats.get("matchers", {}).items():
+        entry = into.setdefault(matcher, {"visited": 0, "accepted": 0, "wall_seconds": 0})
+        entry["visited"] += counts.get("visited", 0)
+        entry["accepted"] += counts.get("accepted", 0)
+        entry["wall_seconds"] += counts.get("wall_seconds", 0)
+
+def accumulate_pages(into, stats):
+    for outcome, count in stats.get("pages", {}).items():
+        into[outcome] = into.get(outcome, 0) + count
+
+#---------------------------------------------------------------------------------------------------
+
+def run_mode(args, headers, name, flag, fresh, yaml_dir, scratch, io=None, cold=False):
+    """Runs one mode over every header, `args.repeat` times, and summarizes it. A `fresh` mode
+    starts every pass with an empty YAML directory; a `cold` one with none of it cached. `io`
+    overrides `--io`."""
+    walls = []
+    peak_rss = 0
+    failures = 0
+    phases = {}
+    matchers = {}
+    pages = {}
+    stats_path = os.path.join(scratch, "stats.json")
+
+    for repetition in range(args.repeat):
+        if fresh:
+            shutil.rmtree(yaml_dir, ignore_errors=True)
+        if cold:
+            evict_page_cache(yaml_dir)
+        wall = 0
+        for header in headers:
+            command = hyde_command(args, flag, header, yaml_dir, stats_path, io)
+            code, elapsed, rss, stderr = run_timed(command)
+            wall += elapsed
+            peak_rss = max(peak_rss, rss)
+            if code != 0:
+                failures += 1
+                if args.verbose:
+                    sys.stderr.write(f"{name}: {header}: exit {code}\n{stderr}")
+
+            # Phase times and counters come from the last repetition only.
+            if repetition + 1 == args.repeat and os.path.exists(stats_path):
+                with open(stats_path, encoding="utf-8") as f:
+                    stats = json.load(f)
+                accumulate_phases(phases, stats)
+                accumulate_matchers(matchers, stats)
+                accumulate_pages(pages, stats)
+                os.remove(stats_path)
+        walls.append(wall)
+
+    result = {
+        "wall_seconds": statistics.median(walls),
+        "wall_seconds_min": min(walls),
+        "wall_seconds_max": max(walls),
+        "peak_rss_bytes": peak_rss,
+        "failures": failures,
+        "phases": phases,
+        "matchers": matchers,
+        "pages": pages,
+    }
+
+    if args.syscalls:
+        if fresh:
+            shutil.rmtree(yaml_dir, ignore_errors=True)
+        total = 0
+        calls = {}
+        for header in headers:
+            count, per_call = count_syscalls(
+                hyde_command(args, flag, header, yaml_dir, stats_path, io), scratch)
+            total += count
+            for syscall, n in per_call.items():
+                calls[syscall] = calls.get(syscall, 0) + n
+        result["syscalls"] = total
+        result["syscalls_by_name"] = dict(sorted(calls.items(), key=lambda x: -x[1]))
+
+    return result
+
+#---------------------------------------------------------------------------------------------------
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--hyde", required=True, help="path to the hyde executable")
+    parser.add_argument("--corpus", required=True, help="directory of headers to document")
+    parser.add_argument("--output", help="path to write the JSON report (default: stdout)")
+    parser.add_argument("--repeat", type=int, default=3, help="timed runs per mode")
+    parser.add_argument("--std", default="c++17", help="language standard to parse with")
+    parser.add_argument("--io", choices=IO_BACKENDS,
+                        help="-hyde-io backend to run with (default: hyde's own)")
+    parser.add_argument("--cold-cache", action="store_true",
+                        help="also run validate and update-unchanged with a cold page cache, "
+                             "once per -hyde-io backend (Linux only)")
+    parser.add_argument("--no-syscalls", dest="syscalls", action="store_false",
+                        help="do not count syscalls, even if strace is available")
+    parser.add_argument("--verbose", action="store_true", help="echo hyde's errors")
+    args = parser.parse_args()
+
+    args.hyde = os.path.abspath(args.hyde)
+    args.corpus = os.path.abspath(args.corpus)
+    args.syscalls = args.syscalls and sys.platform.startswith("linux") and \
+                    shutil.which("strace") is not None
+    if args.cold_cache and not sys.platform.startswith("linux"):
+        sys.exit("--cold-cache is only supported on Linux")
+
+    headers = sorted(os.path.join(args.corpus, name) for name in os.listdir(args.corpus)
+                     if name.endswith((".hpp", ".h")))
+    if not headers:
+        sys.exit(f"{args.corpus}: no headers found")
+
+    report = {
+        "hyde": args.hyde,
+        "corpus": args.corpus,
+        "headers": len(headers),
+        "repeat": args.repeat,
+        "modes": {},
+    }
+
+    with tempfile.TemporaryDirectory(prefix="hyde_bench_") as scratch:
+        yaml_dir = os.path.join(scratch, "docs")
+        runs = [(name, flag, fresh, None, False) for name, flag, fresh in MODES]
+        if args.cold_cache:
+            runs += [(f"{name}-cold-{io}", flag, False, io, True)
+                     for io in IO_BACKENDS
+                     for name, flag, _ in MODES if name in ("validate", "update-unchanged")]
+        for name, flag, fresh, io, cold in runs:
+            result = run_mode(args, headers, name, flag, fresh, yaml_dir, scratch, io, cold)
+            report["modes"][name] = result
+
+            sys.stderr.write(f"{name:>18}: {result['wall_seconds']:8.3f}s "
+                             f"{result['peak_rss_bytes'] / (1024 * 1024):8.1f}MiB" +
+                             (f" {result['syscalls']:>10} syscalls" if "syscalls" in result else "") +
+                             (f" ({result['failures']} failed)" if result["failures"] else "") +
+                             "\n")
+
+    contents = json.dumps(report, indent=4) + "\n"
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            f.write(contents)
+    else:
+        sys.stdout.write(contents)
+
+#---------------------------------------------------------------------------------------------------
+
+if __name__ == "__main__":
+    main()
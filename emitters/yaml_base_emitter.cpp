@@ -13,14 +13,29 @@ written permission of Adobe.
 #include "yaml_base_emitter.hpp"
 
 // stdc++
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <optional>
+#include <random>
+#include <sstream>
 
 // yaml-cpp
 #include "yaml-cpp/yaml.h"
 
+// clang/llvm
+// clang-format off
+#include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "llvm/Support/TimeProfiler.h"
+#include "_clang_include_suffix.hpp" // must be last to re-enable warnings
+// clang-format on
+
 // application
 #include "emitters/yaml_base_emitter_fwd.hpp"
+#include "file_lock.hpp"
 #include "json.hpp"
 #include "matchers/utilities.hpp"
 
@@ -63,38 +78,6 @@ YAML::Node update_cleanup(const YAML::Node& node) {
 
 /**************************************************************************************************/
 
-hyde::json yaml_to_json(const YAML::Node& yaml) {
-    switch (yaml.Type()) {
-        case YAML::NodeType::Null: {
-            return hyde::json();
-        } break;
-        case YAML::NodeType::Scalar: {
-            return yaml.Scalar();
-        } break;
-        case YAML::NodeType::Sequence: {
-            hyde::json result = hyde::json::array();
-            for (std::size_t i{0}, count{yaml.size()}; i < count; ++i) {
-                result.emplace_back(yaml_to_json(yaml[i]));
-            }
-            return result;
-        } break;
-        case YAML::NodeType::Map: {
-            hyde::json result = hyde::json::object();
-            for (auto iter{yaml.begin()}, last{yaml.end()}; iter != last; ++iter) {
-                if (!iter->first.IsScalar()) throw std::runtime_error("key is not scalar?");
-                result[iter->first.Scalar()] = yaml_to_json(iter->second);
-            }
-            return result;
-        } break;
-        case YAML::NodeType::Undefined: {
-            throw std::runtime_error("YAML is not defined!");
-        } break;
-    }
-    return hyde::json();
-}
-
-/**************************************************************************************************/
-
 YAML::Node json_to_yaml(const hyde::json& json) {
     switch (json.type()) {
         case hyde::json::value_t::null: {
@@ -139,57 +122,6 @@ YAML::Node json_to_yaml(const hyde::json& json) {
     return YAML::Node();
 }
 
-/**************************************************************************************************/
-
-YAML::Node json_to_yaml_ordered(hyde::json j) {
-    // YAML preserves the order of addition, while JSON orders lexicographically
-    // by key value. We want the values common to all jekyll pages to appear
-    // higher in the YAML than other keys, so we do a specific ordering here.
-
-    YAML::Node result;
-
-    const auto move_key = [&](const std::string& key) {
-        if (!j.count(key)) return;
-        result[key] = json_to_yaml(j[key]);
-        j.erase(key);
-    };
-
-    // These are in some ROUGH order/grouping from generic to specific fields.
-
-    move_key("layout");
-    move_key("title");
-    move_key("owner");
-    move_key("brief");
-    move_key("tags");
-    move_key("inline");
-    move_key("library-type");
-    move_key("defined_in_file");
-    move_key("declaration");
-    move_key("annotation");
-
-    move_key("ctor");
-    move_key("dtor");
-    move_key("is_ctor");
-    move_key("is_dtor");
-
-    move_key("typedefs");
-    move_key("fields");
-    move_key("methods");
-    move_key("overloads");
-
-    if (j.count("hyde")) {
-        result["hyde"] = json_to_yaml_ordered(j["hyde"]);
-        j.erase("hyde");
-    }
-
-    // copy over the remainder of the keys.
-    for (auto it = j.begin(); it != j.end(); ++it) {
-        result[it.key()] = json_to_yaml(it.value());
-    }
-
-    return result;
-}
-
 /**************************************************************************************************/
 // See Issue #75 and PR #80. Take the relevant hyde fields and move them under a top-level
 // `hyde` subfield. Only do this when we're asked to, in case this has already been done and those
@@ -234,6 +166,72 @@ static const std::string front_matter_end_k("\n---\n");
 
 /**************************************************************************************************/
 
+std::string render_documentation(const YAML::Node& front_matter, const std::string& remainder) {
+    std::stringstream result;
+
+    result << front_matter_begin_k;
+    result << front_matter;
+    result << front_matter_end_k;
+    result << remainder;
+
+    return result.str();
+}
+
+// Pages are cached by their normalized paths, so that those built up differently still match.
+std::string page_key(const std::filesystem::path& path) {
+    return path.lexically_normal().string();
+}
+
+/**************************************************************************************************/
+// Only touch the file system when the bytes we would write differ from the ones already there.
+// Rewriting identical pages bumps their mtimes, which in turn causes needless rebuilds of the
+// static site and churn in version control.
+// With a page cache, the comparison is against the cached page, and the write is left to it.
+bool write_if_changed(const std::filesystem::path& path,
+                      const std::string& contents,
+                      hyde::file_manifest* manifest,
+                      bool* out_written = nullptr,
+                      hyde::page_cache* pages = nullptr) {
+    llvm::TimeTraceScope trace("WriteDocumentation", [&] { return path.string(); });
+    std::error_code ec;
+
+    if (out_written) *out_written = false;
+
+    if (pages) {
+        const std::string* have = pages->find(path);
+
+        if (have && *have == contents) {
+            return false;
+        }
+
+        pages->write(path, contents);
+
+        if (out_written) *out_written = true;
+
+        return false;
+    }
+
+    const bool existed = std::filesystem::exists(path, ec);
+
+    if (existed && hyde::file_slurp(path) == contents) {
+        return false;
+    }
+
+    if (hyde::write_file_atomic(path, contents)) {
+        return true;
+    }
+
+    if (manifest) {
+        (existed ? manifest->_modified : manifest->_created).push_back(path);
+    }
+
+    if (out_written) *out_written = true;
+
+    return false;
+}
+
+/**************************************************************************************************/
+
 } // namespace
 
 /**************************************************************************************************/
@@ -242,7 +240,134 @@ namespace hyde {
 
 /**************************************************************************************************/
 
-file_checker yaml_base_emitter::checker_s; // REVISIT (fbrereto) : Global. Bad programmer. No donut.
+std::string file_slurp(const std::filesystem::path& path) {
+    std::ifstream input(path);
+    std::stringstream contents;
+    contents << input.rdbuf();
+    return contents.str();
+}
+
+/**************************************************************************************************/
+// Write `contents` to a uniquely-named temporary file next to `path`, then rename it into place.
+// Renames within a directory are atomic, so readers (or a subsequent run after a crash) will only
+// ever see either the old file or the new one, never a partially written one.
+bool write_file_atomic(const std::filesystem::path& path, const std::string& contents) {
+    thread_local std::mt19937 engine{std::random_device()()};
+    auto temp_path = path;
+    temp_path += ".hyde_" + std::to_string(engine()) + ".tmp";
+
+    {
+        std::ofstream output(temp_path);
+        if (!output) {
+            std::cerr << "./" << path.string() << ": could not open file for output\n";
+            return true;
+        }
+
+        output << contents;
+
+        if (!output.flush()) {
+            std::cerr << "./" << path.string() << ": could not write file\n";
+            output.close();
+            std::error_code ec;
+            std::filesystem::remove(temp_path, ec);
+            return true;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+
+    if (ec) {
+        std::cerr << "./" << path.string() << ": could not replace file (" << ec.message() << ")\n";
+        std::filesystem::remove(temp_path, ec);
+        return true;
+    }
+
+    return false;
+}
+
+/**************************************************************************************************/
+
+hyde::json yaml_to_json(const YAML::Node& yaml) {
+    switch (yaml.Type()) {
+        case YAML::NodeType::Null: {
+            return hyde::json();
+        } break;
+        case YAML::NodeType::Scalar: {
+            return yaml.Scalar();
+        } break;
+        case YAML::NodeType::Sequence: {
+            hyde::json result = hyde::json::array();
+            for (std::size_t i{0}, count{yaml.size()}; i < count; ++i) {
+                result.emplace_back(yaml_to_json(yaml[i]));
+            }
+            return result;
+        } break;
+        case YAML::NodeType::Map: {
+            hyde::json result = hyde::json::object();
+            for (auto iter{yaml.begin()}, last{yaml.end()}; iter != last; ++iter) {
+                if (!iter->first.IsScalar()) throw std::runtime_error("key is not scalar?");
+                result[iter->first.Scalar()] = yaml_to_json(iter->second);
+            }
+            return result;
+        } break;
+        case YAML::NodeType::Undefined: {
+            throw std::runtime_error("YAML is not defined!");
+        } break;
+    }
+    return hyde::json();
+}
+
+/**************************************************************************************************/
+
+YAML::Node json_to_yaml_ordered(hyde::json j) {
+    // YAML preserves the order of addition, while JSON orders lexicographically
+    // by key value. We want the values common to all jekyll pages to appear
+    // higher in the YAML than other keys, so we do a specific ordering here.
+
+    YAML::Node result;
+
+    const auto move_key = [&](const std::string& key) {
+        if (!j.count(key)) return;
+        result[key] = json_to_yaml(j[key]);
+        j.erase(key);
+    };
+
+    // These are in some ROUGH order/grouping from generic to specific fields.
+
+    move_key("layout");
+    move_key("title");
+    move_key("owner");
+    move_key("brief");
+    move_key("tags");
+    move_key("inline");
+    move_key("library-type");
+    move_key("defined_in_file");
+    move_key("declaration");
+    move_key("annotation");
+
+    move_key("ctor");
+    move_key("dtor");
+    move_key("is_ctor");
+    move_key("is_dtor");
+
+    move_key("typedefs");
+    move_key("fields");
+    move_key("methods");
+    move_key("overloads");
+
+    if (j.count("hyde")) {
+        result["hyde"] = json_to_yaml_ordered(j["hyde"]);
+        j.erase("hyde");
+    }
+
+    // copy over the remainder of the keys.
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        result[it.key()] = json_to_yaml(it.value());
+    }
+
+    return result;
+}
 
 /**************************************************************************************************/
 
@@ -1004,75 +1129,274 @@ struct transcribe_pair {
 
 using transcribe_pairs = std::vector<transcribe_pair>;
 
-// This is O(N^2), where N is the size of both `src` and `dst`. Therefore transcription
-// should only be run when it is shown to be necessary. At the same time, if your code base
-// has enough overrides to really slow this algorithm down, hyde's performance is the least
-// of your concerns.
-transcribe_pairs derive_transcribe_pairs(const json& src, const json& dst) {
-    std::vector<std::string> src_keys = object_keys(src);
-    std::vector<std::string> dst_keys = object_keys(dst);
+struct transcription {
+    transcribe_pairs _pairs;
+    std::vector<std::string> _unmatched_src; // `have` keys with no counterpart in `expected`
+    std::vector<std::string> _unmatched_dst; // `expected` keys with no counterpart in `have`
+};
+
+// The distinct trigrams of a key, each packed into an integer.
+std::vector<std::uint32_t> trigrams(const std::string& s) {
+    std::vector<std::uint32_t> result;
 
-    if (src_keys.size() != dst_keys.size()) {
-        std::cerr << "WARNING: transcription key count mismatch\n";
+    for (std::size_t i = 0; i + 3 <= s.size(); ++i) {
+        result.push_back(static_cast<std::uint32_t>(static_cast<unsigned char>(s[i])) << 16 |
+                         static_cast<std::uint32_t>(static_cast<unsigned char>(s[i + 1])) << 8 |
+                         static_cast<std::uint32_t>(static_cast<unsigned char>(s[i + 2])));
     }
 
-    transcribe_pairs result;
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+
+    return result;
+}
+
+// For each `src` key, the indices of the `dst` keys worth scoring against it: the ones that share
+// the most trigrams with it. Sets small enough to score exhaustively skip the index altogether.
+std::vector<std::vector<std::size_t>> transcription_candidates(const std::vector<std::string>& src,
+                                                               const std::vector<std::string>& dst) {
+    constexpr std::size_t max_candidates_k = 8;
+    std::vector<std::vector<std::size_t>> result(src.size());
+
+    if (dst.size() <= 2 * max_candidates_k) {
+        for (auto& candidates : result) {
+            for (std::size_t j = 0; j < dst.size(); ++j) {
+                candidates.push_back(j);
+            }
+        }
+        return result;
+    }
 
-    while (!src_keys.empty()) {
-        transcribe_pair cur_pair;
+    std::unordered_map<std::uint32_t, std::vector<std::size_t>> index;
 
-        // pop a key off the old name set
-        cur_pair.src = std::move(src_keys.back());
-        src_keys.pop_back();
+    for (std::size_t j = 0; j < dst.size(); ++j) {
+        for (const auto& trigram : trigrams(dst[j])) {
+            index[trigram].push_back(j);
+        }
+    }
 
-        // find the best match of the dst keys to the src key
-        std::size_t best_match = std::numeric_limits<std::size_t>::max();
-        std::size_t best_index = 0;
-        for (std::size_t i = 0; i < dst_keys.size(); ++i) {
-            // generate the diff score of the src key and the candidate dst
-            std::size_t cur_match = diff_score(cur_pair.src, dst_keys[i]);
+    std::vector<std::size_t> shared(dst.size(), 0);
+    std::vector<std::size_t> touched;
 
-            if (cur_match > best_match) {
-                continue;
+    for (std::size_t i = 0; i < src.size(); ++i) {
+        for (const auto& trigram : trigrams(src[i])) {
+            const auto found = index.find(trigram);
+            if (found == index.end()) continue;
+            for (const auto& j : found->second) {
+                if (!shared[j]++) touched.push_back(j);
             }
-
-            // if this dst candidate is better than what we've seen, remember that.
-            best_match = cur_match;
-            best_index = i;
         }
 
-        // pair the best match dst and src keys and remove dst
-        cur_pair.dst = std::move(dst_keys[best_index]);
-        dst_keys.erase(dst_keys.begin() + best_index);
+        const auto length_delta = [&](std::size_t j) {
+            return src[i].size() > dst[j].size() ? src[i].size() - dst[j].size() :
+                                                   dst[j].size() - src[i].size();
+        };
+
+        const auto count = std::min(max_candidates_k, touched.size());
+        std::partial_sort(touched.begin(), touched.begin() + count, touched.end(),
+                          [&](std::size_t a, std::size_t b) {
+                              if (shared[a] != shared[b]) return shared[a] > shared[b];
+                              return length_delta(a) < length_delta(b);
+                          });
 
-        // save off the pair and repeat
-        result.emplace_back(std::move(cur_pair));
+        result[i].assign(touched.begin(), touched.begin() + count);
+
+        for (const auto& j : touched) {
+            shared[j] = 0;
+        }
+        touched.clear();
     }
 
     return result;
 }
 
-/**************************************************************************************************/
+// Solve the rectangular assignment problem (Hungarian method, O(rows^2 * cols)) for the
+// `rows` x `cols` cost matrix, where `rows <= cols`. Returns the column assigned to each row.
+std::vector<std::size_t> min_cost_assignment(const std::vector<std::int64_t>& costs,
+                                             std::size_t rows,
+                                             std::size_t cols) {
+    constexpr std::int64_t infinity_k = std::numeric_limits<std::int64_t>::max() / 2;
+    std::vector<std::int64_t> u(rows + 1, 0);
+    std::vector<std::int64_t> v(cols + 1, 0);
+    std::vector<std::size_t> p(cols + 1, 0); // p[j] is the row (1-based) assigned to column j
+    std::vector<std::size_t> way(cols + 1, 0);
+    std::vector<std::int64_t> minv(cols + 1);
+    std::vector<char> used(cols + 1);
+
+    for (std::size_t i = 1; i <= rows; ++i) {
+        p[0] = i;
+        std::size_t j0 = 0;
+        std::fill(minv.begin(), minv.end(), infinity_k);
+        std::fill(used.begin(), used.end(), false);
+
+        do {
+            used[j0] = true;
+            const std::size_t i0 = p[j0];
+            std::int64_t delta = infinity_k;
+            std::size_t j1 = 0;
+
+            for (std::size_t j = 1; j <= cols; ++j) {
+                if (used[j]) continue;
+                const std::int64_t cur = costs[(i0 - 1) * cols + (j - 1)] - u[i0] - v[j];
+                if (cur < minv[j]) {
+                    minv[j] = cur;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
 
-bool yaml_base_emitter::check_map(const std::string& filepath,
-                                  const json& have_node,
-                                  const json& expected_node,
-                                  const std::string& nodepath,
-                                  json& merged_node,
-                                  const std::string& key,
-                                  const check_proc& proc) {
-    const bool at_root = key == "<root>";
+            for (std::size_t j = 0; j <= cols; ++j) {
+                if (used[j]) {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    minv[j] -= delta;
+                }
+            }
 
-    const auto notify = [&](const std::string& validate_message,
-                            const std::string& update_message) {
-        check_notify(filepath, nodepath, key, validate_message, update_message);
-    };
+            j0 = j1;
+        } while (p[j0] != 0);
 
-    if (!expected_node.count(key)) {
-        return check_removed(filepath, have_node, nodepath, key);
+        do {
+            const std::size_t j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0 != 0);
     }
 
-    const json& expected = expected_node[key];
+    std::vector<std::size_t> result(rows);
+
+    for (std::size_t j = 1; j <= cols; ++j) {
+        if (p[j] != 0) result[p[j] - 1] = j - 1;
+    }
+
+    return result;
+}
+
+// Pair up the old (`src`) and new (`dst`) names of the same symbols such that the sum of the diff
+// scores of all the pairs is minimal. Keys present in both sets are paired with themselves first.
+// The remaining keys are scored only against their likeliest candidates (per a trigram index)
+// using a bounded diff score; all other pairings are assumed to share nothing, and cost as much as
+// deleting one key and inserting the other. If the sets differ in size, the keys left over are
+// reported as unmatched.
+transcription derive_transcribe_pairs(const json& src, const json& dst) {
+    transcription result;
+    std::vector<std::string> src_keys;
+    std::vector<std::string> dst_keys;
+
+    for (const auto& key : object_keys(src)) {
+        if (dst.count(key)) {
+            result._pairs.push_back(transcribe_pair{key, key});
+        } else {
+            src_keys.push_back(key);
+        }
+    }
+
+    for (const auto& key : object_keys(dst)) {
+        if (!src.count(key)) dst_keys.push_back(key);
+    }
+
+    if (src_keys.size() != dst_keys.size()) {
+        std::cerr << "WARNING: transcription key count mismatch (" << src_keys.size()
+                  << " old v. " << dst_keys.size() << " new names); some will be unmatched\n";
+    }
+
+    // The assignment wants no more rows than columns.
+    const bool transposed = src_keys.size() > dst_keys.size();
+    const auto& row_keys = transposed ? dst_keys : src_keys;
+    const auto& col_keys = transposed ? src_keys : dst_keys;
+    const std::size_t rows = row_keys.size();
+    const std::size_t cols = col_keys.size();
+
+    if (rows != 0) {
+        std::vector<std::size_t> costs(rows * cols);
+
+        for (std::size_t i = 0; i < rows; ++i) {
+            for (std::size_t j = 0; j < cols; ++j) {
+                costs[i * cols + j] = row_keys[i].size() + col_keys[j].size();
+            }
+        }
+
+        const auto candidates = transcription_candidates(row_keys, col_keys);
+
+        for (std::size_t i = 0; i < rows; ++i) {
+            std::size_t best = std::numeric_limits<std::size_t>::max();
+
+            for (const auto& j : candidates[i]) {
+                auto& cost = costs[i * cols + j];
+                // A candidate worse than the best seen so far by more than the length of a whole
+                // key is not a contender, so there is no need to know exactly how bad it is.
+                const std::size_t slack = std::max(row_keys[i].size(), col_keys[j].size());
+                const std::size_t bound =
+                    best == std::numeric_limits<std::size_t>::max() ? cost :
+                                                                      std::min(cost, best + slack);
+                const std::size_t score = diff_score(row_keys[i], col_keys[j], bound);
+                if (score <= bound) {
+                    cost = score;
+                    best = std::min(best, score);
+                }
+            }
+        }
+
+        // A column left out of the assignment is as good as deleted (or inserted), so charge
+        // that up front by rebasing each column's costs against its own length. Otherwise the
+        // assignment would prefer to leave the best-matching keys unpaired.
+        std::vector<std::int64_t> rebased(rows * cols);
+
+        for (std::size_t i = 0; i < rows; ++i) {
+            for (std::size_t j = 0; j < cols; ++j) {
+                rebased[i * cols + j] = static_cast<std::int64_t>(costs[i * cols + j]) -
+                                        static_cast<std::int64_t>(col_keys[j].size());
+            }
+        }
+
+        const auto assignment = min_cost_assignment(rebased, rows, cols);
+        std::vector<char> assigned(cols, false);
+
+        for (std::size_t i = 0; i < rows; ++i) {
+            const std::size_t j = assignment[i];
+            assigned[j] = true;
+            result._pairs.push_back(transposed ? transcribe_pair{col_keys[j], row_keys[i]} :
+                                                 transcribe_pair{row_keys[i], col_keys[j]});
+        }
+
+        auto& unmatched = transposed ? result._unmatched_src : result._unmatched_dst;
+
+        for (std::size_t j = 0; j < cols; ++j) {
+            if (!assigned[j]) unmatched.push_back(col_keys[j]);
+        }
+    } else {
+        result._unmatched_src = std::move(src_keys);
+        result._unmatched_dst = std::move(dst_keys);
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+bool yaml_base_emitter::check_map(const std::string& filepath,
+                                  const json& have_node,
+                                  const json& expected_node,
+                                  const std::string& nodepath,
+                                  json& merged_node,
+                                  const std::string& key,
+                                  const check_proc& proc) {
+    const bool at_root = key == "<root>";
+
+    const auto notify = [&](const std::string& validate_message,
+                            const std::string& update_message) {
+        check_notify(filepath, nodepath, key, validate_message, update_message);
+    };
+
+    if (!expected_node.count(key)) {
+        return check_removed(filepath, have_node, nodepath, key);
+    }
+
+    const json& expected = expected_node[key];
 
     if (!expected.is_object()) {
         throw std::runtime_error("expected type mismatch?");
@@ -1107,21 +1431,34 @@ bool yaml_base_emitter::check_map(const std::string& filepath,
         `proc` with `have[old_name]` and `expected[new_name]` which will migrate any documentation
         from the old name to the new.
 
-        This capability assumes the overload count of both `have` and `expected` are the same.
-        If any new functions are created or removed between upgrades in the clang driver (e.g.,
-        a new compiler-generated routine is created and documented) that will have to be managed
-        manually. Assuming the count is the same, it also assumes there is a 1:1 mapping from the
-        set of old names to the set of new names. This implies the transcription mode should be
-        done as a separate step from an update. In other words, a transcription assumes the
-        documentation is actually the same between the `have` and `expected` sets, it is _just the
-        overload names_ that have changed, so map the old-named documentation to the new-named
-        documentation as reasonably as possible.
+        The pairing is a global one (the sum of the scores of all pairs is minimized) so a
+        single close-but-wrong match cannot steal the partner of another key. It works best
+        when there is a 1:1 mapping from the set of old names to the set of new names, which
+        implies the transcription mode should be done as a separate step from an update. If the
+        overload counts differ (e.g., a new compiler-generated routine is created and documented
+        between upgrades), the keys that could not be paired are reported, and are then removed or
+        inserted as they would be during an update.
         */
-        for (const auto& pair : derive_transcribe_pairs(have, expected)) {
+        const auto transcribed = derive_transcribe_pairs(have, expected);
+
+        for (const auto& pair : transcribed._pairs) {
             const std::string curnodepath = nodepath + "['" + pair.dst + "']";
             failure |= proc(filepath, have[pair.src], expected[pair.dst], curnodepath,
                             result_map[pair.dst]);
         }
+
+        for (const auto& subkey : transcribed._unmatched_src) {
+            notify("extraneous map key (no transcription match): `" + subkey + "`",
+                   "map key removed (no transcription match): `" + subkey + "`");
+            failure = true;
+        }
+
+        for (const auto& subkey : transcribed._unmatched_dst) {
+            notify("map key missing (no transcription match): `" + subkey + "`",
+                   "map key inserted (no transcription match): `" + subkey + "`");
+            result_map[subkey] = expected[subkey];
+            failure = true;
+        }
     } else {
         std::vector<std::string> keys;
 
@@ -1233,7 +1570,7 @@ std::pair<bool, json> yaml_base_emitter::merge(const std::string& filepath,
 
 /**************************************************************************************************/
 
-inline std::uint64_t fnv_1a(const std::string& s) {
+std::uint64_t fnv_1a(const std::string& s) {
     constexpr std::uint64_t prime_k = 0x100000001b3;
 
     std::uint64_t result(0xcbf29ce484222325);
@@ -1247,6 +1584,318 @@ inline std::uint64_t fnv_1a(const std::string& s) {
 
 /**************************************************************************************************/
 
+void fingerprint_cache::load(std::filesystem::path path) {
+    _path = std::move(path);
+    _entries.clear();
+    _dirty = false;
+
+    if (!std::filesystem::exists(_path)) return;
+
+    try {
+        const json cache = json::parse(std::ifstream(_path));
+
+        for (const auto& item : cache.items()) {
+            const auto& value = item.value();
+            entry cur_entry;
+            cur_entry._fingerprint._expected = value.at("expected").get<std::uint64_t>();
+            cur_entry._fingerprint._file = value.at("file").get<std::uint64_t>();
+            cur_entry._fingerprint._clean = value.at("clean").get<bool>();
+            if (value.count("inherited")) {
+                cur_entry._fingerprint._inherited = value.at("inherited");
+            }
+            _entries[item.key()] = std::move(cur_entry);
+        }
+    } catch (...) {
+        // A bad cache costs us nothing but time. Start over.
+        std::cerr << "./" << _path.string() << ": could not parse fingerprints; ignoring\n";
+        _entries.clear();
+        _dirty = true;
+    }
+}
+
+/**************************************************************************************************/
+
+bool fingerprint_cache::save() {
+    // Entries that were not touched in this run are for pages that are no longer emitted.
+    for (auto iter = _entries.begin(); iter != _entries.end();) {
+        if (iter->second._touched) {
+            ++iter;
+        } else {
+            iter = _entries.erase(iter);
+            _dirty = true;
+        }
+    }
+
+    if (!_dirty || _path.empty()) return false;
+
+    json::object_t cache;
+
+    for (const auto& [key, cur_entry] : _entries) {
+        json value = json::object();
+        value["expected"] = cur_entry._fingerprint._expected;
+        value["file"] = cur_entry._fingerprint._file;
+        value["clean"] = cur_entry._fingerprint._clean;
+        if (!cur_entry._fingerprint._inherited.empty()) {
+            value["inherited"] = cur_entry._fingerprint._inherited;
+        }
+        cache[key] = std::move(value);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(_path.parent_path(), ec);
+
+    if (ec) {
+        std::cerr << "./" << _path.parent_path().string()
+                  << ": directory could not be created (" << ec << ")\n";
+        return true;
+    }
+
+    return write_file_atomic(_path, json(std::move(cache)).dump() + '\n');
+}
+
+/**************************************************************************************************/
+
+const fingerprint* fingerprint_cache::find(const std::string& key) const {
+    auto found = _entries.find(key);
+    return found == _entries.end() ? nullptr : &found->second._fingerprint;
+}
+
+/**************************************************************************************************/
+
+void fingerprint_cache::store(const std::string& key, fingerprint value) {
+    auto& cur_entry = _entries[key];
+    const auto& prior = cur_entry._fingerprint;
+
+    _dirty |= prior._expected != value._expected || prior._file != value._file ||
+              prior._clean != value._clean || prior._inherited != value._inherited;
+
+    cur_entry._fingerprint = std::move(value);
+    cur_entry._touched = true;
+}
+
+/**************************************************************************************************/
+
+void page_cache::prefetch(const std::filesystem::path& directory) {
+    llvm::TimeTraceScope trace("PrefetchDocumentation", [&] { return directory.string(); });
+    std::vector<std::filesystem::path> paths;
+    std::error_code ec;
+
+    for (std::filesystem::recursive_directory_iterator iter(directory, ec), last;
+         !ec && iter != last; iter.increment(ec)) {
+        const auto& path = iter->path();
+        std::error_code type_ec;
+        if (path.extension() != ".md" || !iter->is_regular_file(type_ec)) continue;
+        if (_pages.count(page_key(path))) continue;
+        paths.push_back(path);
+    }
+
+    // If the directory could not be read through, what is missing may yet be on disk.
+    if (ec && ec != std::errc::no_such_file_or_directory) return;
+
+    auto contents = read_files(paths, _backend);
+
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        // The page was there a moment ago, so failing to read it does not mean it is not there;
+        // it is looked for again when it is looked up.
+        if (!contents[i]) {
+            _unread.insert(page_key(paths[i]));
+            continue;
+        }
+
+        auto& cur_entry = _pages[page_key(paths[i])];
+        cur_entry._existed = true;
+        cur_entry._contents = std::move(contents[i]);
+    }
+
+    auto key = page_key(directory);
+    if (key.empty() || key.back() != std::filesystem::path::preferred_separator) {
+        key += std::filesystem::path::preferred_separator;
+    }
+    _directories.push_back(std::move(key));
+}
+
+/**************************************************************************************************/
+
+bool page_cache::prefetched(const std::string& key) const {
+    if (_unread.count(key)) return false;
+
+    return std::any_of(_directories.begin(), _directories.end(), [&](const std::string& dir) {
+        return key.compare(0, dir.size(), dir) == 0;
+    });
+}
+
+/**************************************************************************************************/
+
+const std::string* page_cache::find(const std::filesystem::path& path) {
+    auto key = page_key(path);
+    const bool prefetched_path = prefetched(key);
+    auto [found, inserted] = _pages.try_emplace(std::move(key));
+    auto& cur_entry = found->second;
+
+    if (inserted && !prefetched_path) {
+        cur_entry._contents = std::move(read_files({path}, io_backend::sync).front());
+        cur_entry._existed = cur_entry._contents.has_value();
+    }
+
+    return cur_entry._contents ? &*cur_entry._contents : nullptr;
+}
+
+/**************************************************************************************************/
+
+void page_cache::write(const std::filesystem::path& path, std::string contents) {
+    auto key = page_key(path);
+    const bool prefetched_path = prefetched(key);
+    auto [found, inserted] = _pages.try_emplace(std::move(key));
+    auto& cur_entry = found->second;
+
+    if (inserted && !prefetched_path) {
+        std::error_code ec;
+        cur_entry._existed = std::filesystem::exists(path, ec);
+    }
+
+    if (!cur_entry._pending) {
+        cur_entry._pending = true;
+        _pending.push_back(found->first);
+    }
+
+    cur_entry._contents = std::move(contents);
+}
+
+/**************************************************************************************************/
+
+bool page_cache::flush() {
+    if (_pending.empty()) return false;
+
+    llvm::TimeTraceScope trace("FlushDocumentation");
+    std::vector<std::pair<std::filesystem::path, std::string>> files;
+
+    files.reserve(_pending.size());
+
+    // The contents are moved out for the write, and back again after.
+    for (const auto& key : _pending) {
+        files.emplace_back(key, std::move(*_pages[key]._contents));
+    }
+
+    const auto failures = write_files_atomic(files, _backend);
+    bool failure{false};
+
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        const auto found = _pages.find(_pending[i]);
+
+        if (failures[i]) {
+            // What is on disk is unknown now, so look again should it come up.
+            _pages.erase(found);
+            failure = true;
+            continue;
+        }
+
+        auto& cur_entry = found->second;
+
+        if (_manifest) {
+            (cur_entry._existed ? _manifest->_modified : _manifest->_created)
+                .push_back(std::move(files[i].first));
+        }
+
+        cur_entry._contents = std::move(files[i].second);
+        cur_entry._existed = true;
+        cur_entry._pending = false;
+    }
+
+    _pending.clear();
+
+    return failure;
+}
+
+/**************************************************************************************************/
+
+const std::vector<transcription_index::entry>& transcription_index::directory(
+    const std::filesystem::path& parent) {
+    const auto found = _directories.find(parent.string());
+
+    if (found != _directories.end()) return found->second;
+
+    std::vector<entry>& result = _directories[parent.string()];
+    const std::string& current_version = hyde_version();
+
+    for (const auto& dir_entry : std::filesystem::directory_iterator(parent)) {
+        const auto sibling = dir_entry.path();
+        if (!is_directory(sibling)) continue;
+        const auto index_path = sibling / index_filename_k;
+
+        if (!exists(index_path)) {
+            std::cerr << "WARN: expected " << index_path.string() << " but did not find one\n";
+            continue;
+        }
+
+        const auto have_docs = parse_documentation(index_path, true);
+
+        if (have_docs._error) {
+            std::cerr << "WARN: expected " << index_path.string() << " to have docs\n";
+            continue;
+        }
+
+        const auto& have = have_docs._json;
+
+        if (have.count("hyde")) {
+            const auto& have_hyde = have.at("hyde");
+            if (have_hyde.count("version")) {
+                // Transcription is when we're going from a previous version of hyde to this one.
+                // So if the versions match, this is a directory that has already been transcribed.
+                // (Transcribing from a newer version of hyde docs to older ones isn't supported.)
+                if (static_cast<const std::string&>(have_hyde.at("version")) == current_version) {
+                    continue;
+                }
+            }
+        }
+
+        // REVISIT (fosterbrereton): Are these titles editable? Would
+        // users muck with them and thus break this algorithm?
+        result.push_back(entry{sibling, static_cast<const std::string&>(have["title"])});
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+std::filesystem::path transcription_index::find(const std::filesystem::path& dst,
+                                                const std::string& title) {
+    std::size_t best_match = std::numeric_limits<std::size_t>::max();
+    std::filesystem::path result;
+
+    for (const auto& candidate : directory(dst.parent_path())) {
+        // score going from what we have to what this version computed.
+        const auto match = diff_score(candidate._title, title);
+
+        if (match > best_match) {
+            continue;
+        }
+
+        best_match = match;
+        result = candidate._path;
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+void transcription_index::renamed(const std::filesystem::path& src) {
+    // Once renamed the directory is rewritten by this version of hyde, which would have excluded it
+    // from the index had it been seen after the fact.
+    const auto found = _directories.find(src.parent_path().string());
+
+    if (found == _directories.end()) return;
+
+    auto& entries = found->second;
+
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [&](const entry& e) { return e._path == src; }),
+                  entries.end());
+}
+
+/**************************************************************************************************/
+
 std::string yaml_base_emitter::filename_truncate(std::string s) {
     if (s.size() <= 32) return s;
 
@@ -1282,24 +1931,21 @@ std::filesystem::path yaml_base_emitter::directory_mangle(std::filesystem::path
 
 bool yaml_base_emitter::create_directory_stub(std::filesystem::path p) {
     auto stub_name = p / index_filename_k;
+    const bool stub_exists =
+        _options._pages ? _options._pages->find(stub_name) != nullptr : exists(stub_name);
 
-    if (exists(stub_name)) return false;
+    if (stub_exists) return false;
 
-    std::ofstream output(stub_name);
-
-    if (!output) {
-        std::cerr << stub_name.string() << ": could not create directory stub\n";
-        return true;
-    }
-
-    static const auto stub_json_k = json::object_t{
+    const auto stub_json = json::object_t{
         {"layout", "directory"},
         {"title", p.filename().string()},
     };
 
-    output << front_matter_begin_k;
-    output << json_to_yaml_ordered(stub_json_k);
-    output << front_matter_end_k;
+    if (write_if_changed(stub_name, render_documentation(json_to_yaml_ordered(stub_json), ""),
+                         _options._manifest, nullptr, _options._pages)) {
+        std::cerr << stub_name.string() << ": could not create directory stub\n";
+        return true;
+    }
 
     return false;
 }
@@ -1321,7 +1967,7 @@ bool yaml_base_emitter::create_path_directories(std::filesystem::path p) {
     std::reverse(ancestors.begin(), ancestors.end());
 
     for (const auto& ancestor : ancestors) {
-        if (checker_s.exists(ancestor)) continue;
+        if (_options._checker->exists(ancestor)) continue;
 
         if (_mode == yaml_mode::validate) {
             return true;
@@ -1330,11 +1976,9 @@ bool yaml_base_emitter::create_path_directories(std::filesystem::path p) {
             create_directory(ancestor, ec);
 
             if (ec) {
-                static std::map<std::string, bool> bad_path_map_s;
-                const auto bad_path = ancestor.string();
-                if (!bad_path_map_s.count(bad_path))
-                    std::cerr << bad_path << ": directory could not be created (" << ec << ")\n";
-                bad_path_map_s[bad_path] = true;
+                if (_options._checker->first_failure(ancestor))
+                    std::cerr << ancestor.string() << ": directory could not be created (" << ec
+                              << ")\n";
                 return true;
             }
 
@@ -1349,8 +1993,8 @@ bool yaml_base_emitter::create_path_directories(std::filesystem::path p) {
 
 /**************************************************************************************************/
 
-auto load_yaml(const std::filesystem::path& path) try {
-    return YAML::LoadFile(path.c_str());
+auto load_yaml(const std::filesystem::path& path, const std::string& yaml_src) try {
+    return YAML::Load(yaml_src);
 } catch (...) {
     std::cerr << "YAML File: " << path.string() << '\n';
     throw;
@@ -1359,14 +2003,21 @@ auto load_yaml(const std::filesystem::path& path) try {
 /**************************************************************************************************/
 
 documentation parse_documentation(const std::filesystem::path& path, bool fixup_subfield) {
-    // we have to load the file ourselves and find the place where the
-    // front-matter ends and any other relevant documentation begins. We
-    // need to do this for the boilerpolate step to keep it from blasting
-    // out any extra documentation that's already been added.
-    std::ifstream have_file(path);
-    std::stringstream have_contents_stream;
-    have_contents_stream << have_file.rdbuf();
-    std::string have_contents = have_contents_stream.str();
+    return parse_documentation(path, file_slurp(path), fixup_subfield);
+}
+
+/**************************************************************************************************/
+
+documentation parse_documentation(const std::filesystem::path& path,
+                                  std::string have_contents,
+                                  bool fixup_subfield) {
+    llvm::TimeTraceScope trace("ParseDocumentation", [&] { return path.string(); });
+
+    // we have to find the place where the front-matter ends and any other
+    // relevant documentation begins. We need to do this for the boilerpolate
+    // step to keep it from blasting out any extra documentation that's already
+    // been added. Only the front-matter is parsed as YAML, so the file is
+    // read just the once.
     documentation result;
 
     if (have_contents.find_first_of(front_matter_begin_k) != 0) {
@@ -1388,7 +2039,7 @@ documentation parse_documentation(const std::filesystem::path& path, bool fixup_
     have_contents.erase(0, front_matter_end);
 
     result._remainder = std::move(have_contents);
-    result._json = yaml_to_json(load_yaml(path));
+    result._json = yaml_to_json(load_yaml(path, yaml_src));
 
     if (fixup_subfield) {
         result._json = fixup_hyde_subfield(std::move(result._json));
@@ -1399,19 +2050,99 @@ documentation parse_documentation(const std::filesystem::path& path, bool fixup_
 
 /**************************************************************************************************/
 
-bool write_documentation(const documentation& docs, const std::filesystem::path& path) {
-    std::ofstream output(path);
-    if (!output) {
-        std::cerr << "./" << path.string() << ": could not open file for output\n";
-        return true;
+bool write_documentation(const documentation& docs,
+                         const std::filesystem::path& path,
+                         file_manifest* manifest,
+                         bool* out_written,
+                         page_cache* pages) {
+    const auto contents = render_documentation(json_to_yaml_ordered(docs._json), docs._remainder);
+    return write_if_changed(path, contents, manifest, out_written, pages);
+}
+
+/**************************************************************************************************/
+
+bool write_manifest(const file_manifest& manifest,
+                    const std::filesystem::path& path,
+                    bool merge) {
+    // What became of each page, by the end of everything the manifest covers. A page created and
+    // then modified was created, while one created and then removed is no business of the
+    // manifest's at all; one removed and then created again was modified.
+    enum class state { created, modified, removed };
+    std::map<std::string, state> states;
+
+    const auto record = [&](const std::string& entry, state next) {
+        auto found = states.find(entry);
+
+        if (found == states.end()) {
+            states.emplace(entry, next);
+        } else if (found->second == state::created && next == state::removed) {
+            states.erase(found);
+        } else if (found->second == state::created) {
+            // Still created.
+        } else if (found->second == state::removed && next != state::removed) {
+            found->second = state::modified;
+        } else {
+            found->second = next;
+        }
+    };
+
+    const char* const keys[] = {"created", "modified", "removed"};
+    const state key_states[] = {state::created, state::modified, state::removed};
+
+    // Other runs may be merging into the manifest at the same time; each must see what those
+    // before it wrote.
+    std::optional<file_lock> lock;
+
+    if (merge) {
+        auto lock_path = path;
+        lock_path += ".lock";
+        lock.emplace(lock_path);
+
+        if (!lock->locked()) {
+            std::cerr << "./" << lock_path.string() << ": could not lock manifest\n";
+            return true;
+        }
+
+        std::error_code ec;
+        if (std::filesystem::exists(path, ec)) {
+            const json previous = json::parse(std::ifstream(path), nullptr, false);
+
+            if (!previous.is_object()) {
+                std::cerr << "./" << path.string() << ": could not parse manifest; overwriting\n";
+            } else {
+                for (std::size_t i = 0; i < std::size(keys); ++i) {
+                    if (!previous.count(keys[i]) || !previous[keys[i]].is_array()) continue;
+
+                    for (const auto& entry : previous[keys[i]]) {
+                        if (!entry.is_string()) {
+                            std::cerr << "./" << path.string() << ": skipping malformed `"
+                                      << keys[i] << "` entry " << entry.dump() << '\n';
+                            continue;
+                        }
+                        record(entry.get<std::string>(), key_states[i]);
+                    }
+                }
+            }
+        }
     }
 
-    output << front_matter_begin_k;
-    output << json_to_yaml_ordered(docs._json);
-    output << front_matter_end_k;
-    output << docs._remainder;
+    // A run writes its pages before the extraneous file check removes any.
+    for (const auto& entry : manifest._created) record(entry.string(), state::created);
+    for (const auto& entry : manifest._modified) record(entry.string(), state::modified);
+    for (const auto& entry : manifest._removed) record(entry.string(), state::removed);
 
-    return false;
+    json result = json::object();
+
+    for (std::size_t i = 0; i < std::size(keys); ++i) {
+        result[keys[i]] = json::array();
+    }
+
+    // `states` is ordered, so each list is sorted.
+    for (const auto& [entry, outcome] : states) {
+        result[keys[static_cast<std::size_t>(outcome)]].push_back(entry);
+    }
+
+    return write_file_atomic(path, result.dump(2) + '\n');
 }
 
 /**************************************************************************************************/
@@ -1441,11 +2172,62 @@ bool yaml_base_emitter::reconcile(json expected,
     }
 
     std::string relative_path(("." / relative(path, root_path)).string());
+    llvm::TimeTraceScope trace("ReconcileDocumentation", relative_path);
 
     failure |= create_path_directories(path);
 
-    if (checker_s.exists(path)) {
-        const auto have_docs = parse_documentation(path, true);
+    fingerprint_cache* fingerprints = _options._fingerprints;
+    page_statistics* statistics = _options._statistics;
+    page_cache* pages = _options._pages;
+    fingerprint print;
+
+    if (fingerprints) {
+        print._expected = fingerprint_expected(expected);
+    }
+
+    // With a page cache, the page is read from it (and only once), and its writes go to it.
+    const std::string* page{nullptr};
+
+    if (pages) {
+        _options._checker->insert(path);
+        page = pages->find(path);
+    }
+
+    if (pages ? page != nullptr : _options._checker->exists(path)) {
+        if (fingerprints) {
+            print._file = page ? fnv_1a(*page) : fnv_1a(file_slurp(path));
+
+            // If neither the page nor what we expect of it have changed since the last run, the
+            // result of the merge is already known. Update mode will produce the same bytes
+            // again, and validate mode can pass so long as the last merge was a clean one.
+            const fingerprint* found = fingerprints->find(relative_path);
+            const bool match =
+                found && found->_expected == print._expected && found->_file == print._file;
+
+            if (match && (_mode == yaml_mode::update || found->_clean)) {
+                out_reconciled = std::move(expected);
+                out_reconciled["documentation_path"] = relative_path;
+                for (const auto& item : found->_inherited.items()) {
+                    out_reconciled["hyde"][item.key()] = item.value();
+                }
+                fingerprints->store(relative_path, *found);
+                if (statistics) {
+                    ++statistics->_unchanged;
+                    ++statistics->_skipped;
+                }
+                return failure;
+            }
+        }
+
+        if (statistics) {
+            std::error_code ec;
+            const auto size = page ? page->size() : std::filesystem::file_size(path, ec);
+            ++statistics->_read;
+            statistics->_yaml_bytes += ec ? 0 : size;
+        }
+
+        const auto have_docs =
+            page ? parse_documentation(path, *page, true) : parse_documentation(path, true);
 
         if (have_docs._error) {
             return true;
@@ -1456,22 +2238,54 @@ bool yaml_base_emitter::reconcile(json expected,
 
         json merged;
 
-        std::tie(failure, merged) = merge(relative_path, have, expected);
+        {
+            llvm::TimeTraceScope merge_trace("MergeDocumentation", relative_path);
+            std::tie(failure, merged) = merge(relative_path, have, expected);
+        }
         out_reconciled = merged;
         out_reconciled["documentation_path"] = relative_path;
 
+        const bool merge_failure = failure;
+        bool write_failure{false};
+        bool written{false};
+
+        if (fingerprints) {
+            print._inherited = inheritable_fields(merged);
+        }
+
         switch (_mode) {
             case hyde::yaml_mode::validate: {
                 // do nothing
             } break;
             case hyde::yaml_mode::transcribe:
             case hyde::yaml_mode::update: {
-                failure = write_documentation({std::move(merged), std::move(remainder)}, path);
+                failure = write_documentation({std::move(merged), std::move(remainder)}, path,
+                                              _options._manifest, &written, pages);
+                write_failure = failure;
             } break;
         }
+
+        if (statistics && !write_failure) {
+            ++(written ? statistics->_written : statistics->_unchanged);
+        }
+
+        if (fingerprints && !write_failure) {
+            // The merge result only describes the file if the file was left as it was. (A write
+            // to the page cache replaces the page it found.)
+            const auto file_hash = _mode == yaml_mode::validate ? print._file :
+                                   page                         ? fnv_1a(*page) :
+                                                                  fnv_1a(file_slurp(path));
+            print._clean = !merge_failure && file_hash == print._file;
+            print._file = file_hash;
+            fingerprints->store(relative_path, std::move(print));
+        }
     } else { // file does not exist
         out_reconciled = expected;
 
+        if (fingerprints) {
+            print._inherited = inheritable_fields(expected);
+        }
+
         switch (_mode) {
             case hyde::yaml_mode::validate: {
                 std::cerr << relative_path << ": required file does not exist\n";
@@ -1483,14 +2297,17 @@ bool yaml_base_emitter::reconcile(json expected,
                 // REVISIT: Refactor all this into a call to write_documentation,
                 // though I'm not sure what the call to `update_cleanup` is all about,
                 // and which was missing from the prior case when the file existed.
-                std::ofstream output(path);
-                if (!output) {
-                    std::cerr << "./" << path.string() << ": could not open file for output\n";
-                    failure = true;
-                } else {
-                    output << front_matter_begin_k;
-                    output << update_cleanup(json_to_yaml_ordered(expected));
-                    output << front_matter_end_k;
+                const auto contents =
+                    render_documentation(update_cleanup(json_to_yaml_ordered(expected)), "");
+                failure = write_if_changed(path, contents, _options._manifest, nullptr, pages);
+
+                if (statistics && !failure) {
+                    ++statistics->_created;
+                }
+
+                if (fingerprints && !failure) {
+                    print._file = fnv_1a(contents);
+                    fingerprints->store(relative_path, std::move(print));
                 }
             } break;
         }
@@ -1501,6 +2318,55 @@ bool yaml_base_emitter::reconcile(json expected,
 
 /**************************************************************************************************/
 
+std::uint64_t yaml_base_emitter::fingerprint_expected(const json& expected) {
+    // Options that change the behavior of the merge have to be a part of the fingerprint, too.
+    return fnv_1a(expected.dump() + '\n' +
+                  std::to_string(static_cast<int>(_options._tested_by)) +
+                  (_editable_title ? "e" : ""));
+}
+
+/**************************************************************************************************/
+
+json yaml_base_emitter::inheritable_fields(const json& node) {
+    // These are the fields `insert_inherited` looks for that do not originate from `expected`.
+    json result = json::object();
+
+    if (node.count("hyde") && node.at("hyde").count("owner")) {
+        result["owner"] = node.at("hyde").at("owner");
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+std::filesystem::path yaml_base_emitter::derive_transcription_src_path(
+    const std::filesystem::path& dst, const std::string& title) {
+    if (_options._transcription_index) {
+        return _options._transcription_index->find(dst, title);
+    }
+
+    return transcription_index().find(dst, title);
+}
+
+/**************************************************************************************************/
+
+void yaml_base_emitter::transcribe_directory(const std::filesystem::path& src,
+                                             const std::filesystem::path& dst) {
+    std::filesystem::rename(src, dst);
+
+    if (_options._transcription_index) {
+        _options._transcription_index->renamed(src);
+    }
+
+    if (_options._manifest) {
+        _options._manifest->_removed.push_back(src);
+        _options._manifest->_created.push_back(dst);
+    }
+}
+
+/**************************************************************************************************/
+
 std::string yaml_base_emitter::defined_in_file(const std::string& src_path,
                                                const std::filesystem::path& src_root) {
     return relative(std::filesystem::path(src_path), src_root).string();
@@ -11,6 +11,12 @@ written permission of Adobe.
 
 #pragma once
 
+// stdc++
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
 // application
 #include "emitters/yaml_base_emitter_fwd.hpp"
 #include "json.hpp"
@@ -18,10 +24,34 @@ written permission of Adobe.
 
 /**************************************************************************************************/
 
+namespace YAML {
+class Node;
+} // namespace YAML
+
+/**************************************************************************************************/
+
 namespace hyde {
 
 /**************************************************************************************************/
 
+// Converts parsed YAML into JSON. Every scalar becomes a string.
+json yaml_to_json(const YAML::Node& yaml);
+
+// Converts JSON into YAML, with the keys common to all pages ahead of the rest.
+YAML::Node json_to_yaml_ordered(json j);
+
+// 64-bit FNV-1a, which (unlike std::hash) hashes the same on every platform.
+std::uint64_t fnv_1a(const std::string& s);
+
+// The contents of the file at `path`, or the empty string if it cannot be read.
+std::string file_slurp(const std::filesystem::path& path);
+
+// Replaces the file at `path` with `contents` such that no reader ever sees it partially written.
+// Returns `true` on failure (which is reported to std::cerr), `false` otherwise.
+bool write_file_atomic(const std::filesystem::path& path, const std::string& contents);
+
+/**************************************************************************************************/
+
 struct file_checker {
     bool exists(std::filesystem::path p) {
         _files.emplace_back(std::move(p));
@@ -40,13 +70,128 @@ struct file_checker {
         return found != _files.end() && *found == p;
     }
 
+    // Marks `p` as checked without looking for it.
+    void insert(std::filesystem::path p) {
+        _files.emplace_back(std::move(p));
+        _sorted = false;
+    }
+
+    const std::vector<std::filesystem::path>& files() const { return _files; }
+
+    // `true` the first time it is given `p`, so a failure to create a path is reported only once.
+    bool first_failure(const std::filesystem::path& p) {
+        return _failures.insert(p.string()).second;
+    }
+
 private:
     std::vector<std::filesystem::path> _files;
+    std::unordered_set<std::string> _failures;
     bool _sorted{false};
 };
 
 /**************************************************************************************************/
 
+struct fingerprint {
+    std::uint64_t _expected{0}; // hash of the `expected` node (and the options affecting merge)
+    std::uint64_t _file{0};     // hash of the documentation file's bytes
+    bool _clean{false};         // `true` iff merging `expected` into the file reported no failures
+    json _inherited;            // merged fields that child emitters inherit (e.g., `owner`)
+};
+
+// The fingerprints of every page emitted for a single source file, kept in a side file under the
+// documentation root. When a page's `expected` node and on-disk contents both match what was seen
+// in a prior run, the (comparatively expensive) YAML parse and merge of that page can be skipped.
+struct fingerprint_cache {
+    void load(std::filesystem::path path);
+
+    /// @return `true` on failure to write, `false` otherwise.
+    bool save();
+
+    const fingerprint* find(const std::string& key) const;
+
+    void store(const std::string& key, fingerprint value);
+
+private:
+    struct entry {
+        fingerprint _fingerprint;
+        bool _touched{false};
+    };
+
+    std::filesystem::path _path;
+    std::unordered_map<std::string, entry> _entries;
+    bool _dirty{false};
+};
+
+/**************************************************************************************************/
+
+// The documentation pages of a single source file, read and written in batches rather than one at
+// a time (see `io_backend`). Pages written are held here, where later lookups find them, until the
+// cache is flushed. Transcription moves directories of pages about as it goes, so it does not use
+// one.
+struct page_cache {
+    page_cache(io_backend backend, file_manifest* manifest)
+        : _backend(backend), _manifest(manifest) {}
+
+    /// Reads every page under `directory` at once. Pages under it that were not found then are
+    /// taken not to exist, without looking for them again; those found but not read are read again
+    /// when looked up.
+    void prefetch(const std::filesystem::path& directory);
+
+    /// @return The contents of the page at `path` (read now if it was not prefetched), or null if
+    /// there is no such page.
+    const std::string* find(const std::filesystem::path& path);
+
+    /// Replaces the page at `path` with `contents` when the cache is flushed.
+    void write(const std::filesystem::path& path, std::string contents);
+
+    /// Writes every page replaced since the last flush, recording each in the manifest (if any) as
+    /// created or modified.
+    /// @return `true` on failure to write any page, `false` otherwise.
+    bool flush();
+
+private:
+    struct entry {
+        std::optional<std::string> _contents; // `std::nullopt` if there is no such page
+        bool _existed{false};                 // whether the page was on disk when first looked up
+        bool _pending{false};                 // whether the page is yet to be written
+    };
+
+    bool prefetched(const std::string& key) const;
+
+    io_backend _backend;
+    file_manifest* _manifest;
+    std::unordered_map<std::string, entry> _pages;
+    std::vector<std::string> _pending;       // keys of the pages to write, in the order written
+    std::vector<std::string> _directories;   // prefetched, each ending with a separator
+    std::unordered_set<std::string> _unread; // keys of pages found but not read by a prefetch
+};
+
+/**************************************************************************************************/
+
+// The titles of the documentation directories a transcription may move from. Each parent directory
+// is indexed on first use, so that every sibling's index.md is parsed at most once per run, rather
+// than once per renamed symbol.
+struct transcription_index {
+    /// @return the sibling directory of `dst` whose title best matches `title`, or an empty path
+    /// if there is none.
+    std::filesystem::path find(const std::filesystem::path& dst, const std::string& title);
+
+    /// Note that `src` has been renamed, and so no longer holds documentation to transcribe.
+    void renamed(const std::filesystem::path& src);
+
+private:
+    struct entry {
+        std::filesystem::path _path;
+        std::string _title;
+    };
+
+    const std::vector<entry>& directory(const std::filesystem::path& parent);
+
+    std::unordered_map<std::string, std::vector<entry>> _directories;
+};
+
+/**************************************************************************************************/
+
 inline bool has_json_flag(const json& j, const char* k) {
     return j.count(k) && j.at(k).get<bool>();
 }
@@ -78,6 +223,14 @@ protected:
                    std::filesystem::path path,
                    json& out_reconciled);
 
+    // Used during transcription to find the old documentation of a renamed symbol, given the
+    // directory the symbol's documentation now belongs in and its new title.
+    std::filesystem::path derive_transcription_src_path(const std::filesystem::path& dst,
+                                                        const std::string& title);
+
+    // Used during transcription to move the documentation of a renamed symbol into place.
+    void transcribe_directory(const std::filesystem::path& src, const std::filesystem::path& dst);
+
     std::string defined_in_file(const std::string& src_path, const std::filesystem::path& src_root);
 
     std::filesystem::path subcomponent(const std::filesystem::path& src_path,
@@ -96,6 +249,8 @@ protected:
     std::string filename_filter(std::string f);
     std::string filename_truncate(std::string s);
 
+    std::filesystem::path directory_mangle(std::filesystem::path p);
+
     void insert_typedefs(const json& j, json& node, const json& inherited);
 
     void check_inline_comments(const json& expected, json& out_merged);
@@ -176,11 +331,13 @@ private:
 
     std::filesystem::path dst_path_append(std::filesystem::path p) { return p; }
 
+    std::uint64_t fingerprint_expected(const json& expected);
+
+    static json inheritable_fields(const json& node);
+
     bool create_directory_stub(std::filesystem::path p);
     bool create_path_directories(std::filesystem::path p);
 
-    std::filesystem::path directory_mangle(std::filesystem::path p);
-
     void check_notify(const std::string& filepath,
                       const std::string& nodepath,
                       const std::string& key,
@@ -202,8 +359,6 @@ protected: // make private?
     const yaml_mode _mode;
     const emit_options _options;
     const bool _editable_title{false};
-
-    static file_checker checker_s;
 };
 
 /**************************************************************************************************/
@@ -12,11 +12,15 @@ written permission of Adobe.
 #pragma once
 
 // stdc++
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 // application
+#include "batch_io.hpp"
 #include "json.hpp"
 
 /**************************************************************************************************/
@@ -30,6 +34,7 @@ static constexpr char const* tag_value_optional_k = "__OPTIONAL__";
 static constexpr char const* tag_value_deprecated_k = "__DEPRECATED__";
 static constexpr char const* tag_value_inlined_k = "__INLINED__";
 static constexpr char const* index_filename_k = "index.md";
+static constexpr char const* fingerprints_directory_k = ".hyde-fingerprints";
 
 /**************************************************************************************************/
 
@@ -54,9 +59,62 @@ static inline bool is_tag(const std::string& s) { return s.substr(0, 2) == "__";
 
 /**************************************************************************************************/
 
+// The set of documentation files touched by a run. Downstream tools (e.g., an incremental Jekyll
+// build) can use this to avoid reprocessing the entire documentation tree.
+struct file_manifest {
+    std::vector<std::filesystem::path> _created;
+    std::vector<std::filesystem::path> _modified;
+    std::vector<std::filesystem::path> _removed;
+};
+
+/// Writes `manifest` to the JSON file at `path`, listing each page once, under what finally
+/// became of it. With `merge`, the manifest already at `path` (if any) is merged into instead,
+/// under a lock (`<path>.lock`), so a series of hyde invocations, even concurrent ones, can share
+/// one manifest; it then grows until whatever reads it starts it afresh. Malformed entries are
+/// skipped.
+/// @return `true` on failure to write, `false` otherwise.
+bool write_manifest(const file_manifest& manifest, const std::filesystem::path& path, bool merge);
+
+/**************************************************************************************************/
+
+// What the extraneous file check needs to know about a run. Sharded runs record it instead of
+// running the check, which is then run over every shard at once by `--merge-shards`.
+struct shard_checks {
+    std::vector<std::filesystem::path> _directories; // sourcefile documentation directories
+    std::vector<std::filesystem::path> _checked;     // every path the emitters looked for
+};
+
+/**************************************************************************************************/
+
+// The number of documentation pages a run has dealt with, by what became of them.
+struct page_statistics {
+    std::size_t _read{0};          // existing pages parsed
+    std::size_t _created{0};       // pages that did not exist before
+    std::size_t _written{0};       // existing pages whose contents changed
+    std::size_t _unchanged{0};     // existing pages left as they were
+    std::size_t _skipped{0};       // unchanged pages that were not even parsed (see fingerprints)
+    std::uintmax_t _yaml_bytes{0}; // size of the existing pages parsed
+};
+
+/**************************************************************************************************/
+
+struct file_checker;
+struct fingerprint_cache;
+struct page_cache;
+struct transcription_index;
+
 struct emit_options {
     attribute_category _tested_by{attribute_category::disabled};
     bool _ignore_extraneous_files{false};
+    bool _use_fingerprints{false};
+    file_manifest* _manifest{nullptr};         // non-owning; may be null.
+    fingerprint_cache* _fingerprints{nullptr}; // non-owning; may be null.
+    transcription_index* _transcription_index{nullptr}; // non-owning; may be null.
+    page_statistics* _statistics{nullptr};               // non-owning; may be null.
+    shard_checks* _shard_checks{nullptr};                // non-owning; may be null.
+    file_checker* _checker{nullptr};                     // non-owning; required.
+    page_cache* _pages{nullptr};                         // non-owning; may be null.
+    io_backend _io_backend{io_backend::sync};
 };
 
 /**************************************************************************************************/
@@ -69,8 +127,23 @@ struct documentation {
 
 documentation parse_documentation(const std::filesystem::path& path, bool fixup_subfield);
 
+/// As above, with the `contents` of the file at `path` already in hand.
+documentation parse_documentation(const std::filesystem::path& path,
+                                  std::string contents,
+                                  bool fixup_subfield);
+
+/// Writes `docs` to `path` iff the rendered output differs from what is already on disk. The write
+/// goes to a temporary file that is then renamed over `path`, so an interrupted run cannot leave a
+/// truncated page behind. If `manifest` is given, the path is recorded as created or modified.
+/// If `out_written` is given, it is set to whether the file was (successfully) written.
+/// If `pages` is given, the page is compared against and written to it instead, and so is only
+/// written (and recorded in its manifest) when it is flushed.
 /// @return `true` on failure to write, `false` otherwise.
-bool write_documentation(const documentation& docs, const std::filesystem::path& path);
+bool write_documentation(const documentation& docs,
+                         const std::filesystem::path& path,
+                         file_manifest* manifest = nullptr,
+                         bool* out_written = nullptr,
+                         page_cache* pages = nullptr);
 
 /**************************************************************************************************/
 
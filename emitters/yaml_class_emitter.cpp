@@ -116,7 +116,7 @@ bool yaml_class_emitter::emit(const json& j, json& out_emitted, const json& inhe
         // folder of `dst` is the actual source folder that holds the old documentation, just under
         // a different name. Find that folder and rename it.
 
-        std::filesystem::rename(derive_transcription_src_path(dst, node["title"]), dst);
+        transcribe_directory(derive_transcription_src_path(dst, node["title"]), dst);
     }
 
     bool failure =
@@ -266,7 +266,7 @@ bool yaml_function_emitter::emit(const json& jsn, json& out_emitted, const json&
         // folder of `dst` is the actual source folder that holds the old documentation, just under
         // a different name. Find that folder and rename it.
 
-        std::filesystem::rename(derive_transcription_src_path(dst, node["title"]), dst);
+        transcribe_directory(derive_transcription_src_path(dst, node["title"]), dst);
     }
 
     return reconcile(std::move(node), _dst_root, dst / (filename + ".md"), out_emitted);
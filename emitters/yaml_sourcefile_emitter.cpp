@@ -44,23 +44,35 @@ bool yaml_sourcefile_emitter::emit(const json& j, json& out_emitted, const json&
 
     insert_typedefs(j, node, inherited);
 
-    _sub_dst = dst_path(j, sub_path);
+    _sub_dst = documentation_directory(j);
 
     return reconcile(std::move(node), _dst_root, _sub_dst / index_filename_k, out_emitted);
 }
 
 /**************************************************************************************************/
 
-bool yaml_sourcefile_emitter::extraneous_file_check_internal(const std::filesystem::path& root,
-                                                             const std::filesystem::path& path) {
+std::filesystem::path yaml_sourcefile_emitter::documentation_directory(const json& j) {
+    return dst_path(j,
+                    subcomponent(static_cast<const std::string&>(j["paths"]["src_path"]), _src_root));
+}
+
+/**************************************************************************************************/
+
+bool yaml_sourcefile_emitter::extraneous_file_check() {
+    return hyde::extraneous_file_check(_sub_dst, *_options._checker);
+}
+
+/**************************************************************************************************/
+
+bool extraneous_file_check(const std::filesystem::path& directory, file_checker& checker) {
     bool failure{false};
-    std::filesystem::directory_iterator first(path);
+    std::filesystem::directory_iterator first(directory);
     std::filesystem::directory_iterator last;
 
     while (first != last) {
         const auto& entry = *first;
 
-        if (!checker_s.checked(entry)) {
+        if (!checker.checked(entry)) {
             std::filesystem::path entry_path(entry);
             if (entry_path.filename() == ".DS_Store") {
                 std::cerr << entry_path.string() << ": Unintended OS file (not a failure)\n";
@@ -72,7 +84,7 @@ bool yaml_sourcefile_emitter::extraneous_file_check_internal(const std::filesyst
         }
 
         if (is_directory(entry)) {
-            failure |= extraneous_file_check_internal(root, entry);
+            failure |= extraneous_file_check(entry, checker);
         }
 
         ++first;
@@ -83,12 +95,6 @@ bool yaml_sourcefile_emitter::extraneous_file_check_internal(const std::filesyst
 
 /**************************************************************************************************/
 
-bool yaml_sourcefile_emitter::extraneous_file_check() {
-    return extraneous_file_check_internal(_sub_dst, _sub_dst);
-}
-
-/**************************************************************************************************/
-
 } // namespace hyde
 
 /**************************************************************************************************/
@@ -37,15 +37,21 @@ struct yaml_sourcefile_emitter : public yaml_base_emitter {
 
     bool extraneous_file_check();
 
-private:
-    bool extraneous_file_check_internal(const std::filesystem::path& root,
-                                        const std::filesystem::path& path);
+    // The directory under which all documentation for the source file will be emitted.
+    std::filesystem::path documentation_directory(const json& matched);
 
+private:
     std::filesystem::path _sub_dst;
 };
 
 /**************************************************************************************************/
 
+/// Reports every file under `directory` that is not in `checker`.
+/// @return `true` if there are any, `false` otherwise.
+bool extraneous_file_check(const std::filesystem::path& directory, file_checker& checker);
+
+/**************************************************************************************************/
+
 } // namespace hyde
 
 /**************************************************************************************************/
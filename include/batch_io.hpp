@@ -0,0 +1,56 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+#pragma once
+
+// stdc++
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+enum class io_backend {
+    sync,    // one file at a time, with the usual system calls
+    io_uring // a batch of files at a time, through io_uring (Linux only)
+};
+
+/// `backend`, or `io_backend::sync` if it is not available in this build or on this system (e.g.,
+/// a kernel without io_uring, or a container that does not allow it).
+io_backend available_io_backend(io_backend backend);
+
+/**************************************************************************************************/
+
+/// Reads every one of `paths`. With `io_backend::io_uring` the opens, reads, and closes of the
+/// files are each submitted a few hundred files at a time, so a cold cache has those all in flight
+/// together.
+/// @return The contents of each file, in order, or `std::nullopt` for those that cannot be read.
+std::vector<std::optional<std::string>> read_files(const std::vector<std::filesystem::path>& paths,
+                                                   io_backend backend);
+
+/// Replaces each file with its contents as `write_file_atomic` does: each is written to a temporary
+/// file, which is then renamed over it. With `io_backend::io_uring` each step is submitted for a
+/// few hundred files at a time. Failures are reported to std::cerr.
+/// @return Whether writing each file failed, in order.
+std::vector<bool> write_files_atomic(
+    const std::vector<std::pair<std::filesystem::path, std::string>>& files, io_backend backend);
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
@@ -0,0 +1,87 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+#pragma once
+
+// stdc++
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+// A queue of at most `capacity` items, handed from the threads that produce them to those that
+// consume them. Producers wait while it is full, so they can get no further ahead of the consumers
+// than that; consumers wait while it is empty, until it is closed.
+template <class T>
+class bounded_queue {
+public:
+    explicit bounded_queue(std::size_t capacity) : _capacity(capacity ? capacity : 1) {}
+
+    bounded_queue(const bounded_queue&) = delete;
+    bounded_queue& operator=(const bounded_queue&) = delete;
+
+    /// Waits for room in the queue, then adds `item` to it.
+    /// @return `true` if the queue was closed (and `item` dropped), `false` otherwise.
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _not_full.wait(lock, [&] { return _closed || _items.size() < _capacity; });
+        if (_closed) return true;
+        _items.push_back(std::move(item));
+        lock.unlock();
+        _not_empty.notify_one();
+        return false;
+    }
+
+    /// Waits for an item, then removes it from the queue.
+    /// @return The item, or `std::nullopt` once the queue is closed and empty.
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _not_empty.wait(lock, [&] { return _closed || !_items.empty(); });
+        if (_items.empty()) return std::nullopt;
+        std::optional<T> result(std::move(_items.front()));
+        _items.pop_front();
+        lock.unlock();
+        _not_full.notify_one();
+        return result;
+    }
+
+    /// Takes no more items. Those already in the queue may still be popped.
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closed = true;
+        }
+        _not_full.notify_all();
+        _not_empty.notify_all();
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _not_full;
+    std::condition_variable _not_empty;
+    std::deque<T> _items;
+    std::size_t _capacity;
+    bool _closed{false};
+};
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
@@ -18,6 +18,7 @@ written permission of Adobe.
 
 #define HYDE_PLATFORM_PRIVATE_APPLE() 0
 #define HYDE_PLATFORM_PRIVATE_MICROSOFT() 0
+#define HYDE_PLATFORM_PRIVATE_LINUX() 0
 
 #define HYDE_PLATFORM(X) HYDE_PRIVATE_STRING_SMASH(HYDE_PLATFORM_PRIVATE_, X)
 
@@ -27,6 +28,20 @@ written permission of Adobe.
 #elif defined(_MSC_VER)
     #undef HYDE_PLATFORM_PRIVATE_MICROSOFT
     #define HYDE_PLATFORM_PRIVATE_MICROSOFT() 1
+#elif defined(__linux__)
+    #undef HYDE_PLATFORM_PRIVATE_LINUX
+    #define HYDE_PLATFORM_PRIVATE_LINUX() 1
+#endif
+
+/**************************************************************************************************/
+
+#define HYDE_FEATURE_PRIVATE_IO_URING() 0
+
+#define HYDE_FEATURE(X) HYDE_PRIVATE_STRING_SMASH(HYDE_FEATURE_PRIVATE_, X)
+
+#if HYDE_PLATFORM(LINUX) && __has_include(<linux/io_uring.h>)
+    #undef HYDE_FEATURE_PRIVATE_IO_URING
+    #define HYDE_FEATURE_PRIVATE_IO_URING() 1
 #endif
 
 /**************************************************************************************************/
@@ -0,0 +1,60 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+#pragma once
+
+// stdc++
+#include <filesystem>
+#include <set>
+#include <string>
+#include <vector>
+
+// clang/llvm
+// clang-format off
+#include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "clang/Tooling/Tooling.h"
+#include "_clang_include_suffix.hpp" // must be last to re-enable warnings
+// clang-format on
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+// Limits the checks clang makes of doc comments (`-Wdocumentation` and the like, which the session
+// makes errors) to the sources being documented. While they are enabled, clang attaches and parses
+// the comment of every declaration as it is parsed, which in the (non-system) headers of other
+// libraries is work done only to check comments hyde never reads. Those of system headers are
+// never checked anyway.
+class documentation_scope : public clang::tooling::SourceFileCallbacks {
+public:
+    /// `next`, if not null, is handed the same calls (a frontend action takes only one of these).
+    documentation_scope(const std::vector<std::string>& sources,
+                        clang::tooling::SourceFileCallbacks* next);
+
+    bool handleBeginSource(clang::CompilerInstance& ci) override;
+
+    void handleEndSource() override;
+
+    /// Whether the comments of the file at (the absolute) `path` are checked.
+    bool checked(const std::filesystem::path& path) const;
+
+private:
+    std::set<std::filesystem::path> _sources; // canonical
+    clang::tooling::SourceFileCallbacks* _next;
+};
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
@@ -0,0 +1,54 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+#pragma once
+
+// stdc++
+#include <filesystem>
+
+// application
+#include "config.hpp"
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+// An exclusive advisory lock on a file, shared with other processes, held for the lifetime of the
+// object. The file is created if it does not exist, and left behind when the lock is released.
+// Lock a file of its own rather than one that is replaced by renaming another over it: the lock
+// would stay with the file replaced.
+class file_lock {
+public:
+    /// Blocks until the lock on `path` is held. Check `locked()` for whether it could be taken.
+    explicit file_lock(const std::filesystem::path& path);
+    ~file_lock();
+
+    file_lock(const file_lock&) = delete;
+    file_lock& operator=(const file_lock&) = delete;
+
+    bool locked() const { return _locked; }
+
+private:
+#if HYDE_PLATFORM(MICROSOFT)
+    void* _handle{nullptr};
+#else
+    int _fd{-1};
+#endif
+    bool _locked{false};
+};
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
@@ -0,0 +1,98 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+#pragma once
+
+// stdc++
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// clang/llvm
+// clang-format off
+#include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "clang/Tooling/Tooling.h"
+#include "_clang_include_suffix.hpp" // must be last to re-enable warnings
+// clang-format on
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+// Records, for every source parsed, the files its translation unit includes, directly or through
+// other headers. Unless `graph_dir` is empty, they are also kept in `graph_dir` as one JSON file
+// per source under `src_root`, laid out like the sources under `src_root`, so runs over different
+// sources never write the same file. Files under `src_root` are recorded relative to it, and others
+// by their absolute paths. System headers are never recorded.
+class include_recorder : public clang::tooling::SourceFileCallbacks {
+public:
+    include_recorder(std::filesystem::path graph_dir, const std::filesystem::path& src_root);
+
+    bool handleBeginSource(clang::CompilerInstance& ci) override;
+
+    void handleEndSource() override;
+
+    /// Called (by the preprocessor) for every file entered by the translation unit.
+    void enter(const std::filesystem::path& path, bool is_main_file);
+
+    /// `true` if the dependencies of a source could not be written.
+    bool failed() const { return _failure; }
+
+    /// Every source parsed so far, with the (canonical) paths of the files it last included.
+    const std::map<std::filesystem::path, std::set<std::filesystem::path>>& includes() const {
+        return _includes;
+    }
+
+private:
+    std::filesystem::path _graph_dir;
+    std::filesystem::path _src_root;
+    std::filesystem::path _source;
+    std::set<std::filesystem::path> _entered;
+    std::map<std::filesystem::path, std::set<std::filesystem::path>> _includes;
+    bool _failure{false};
+};
+
+/**************************************************************************************************/
+
+/// The root of the git repository `directory` is in (the nearest directory, from `directory` up,
+/// holding a `.git`), or `directory` itself if it is not in one. `git diff --name-only` lists
+/// paths relative to this.
+std::filesystem::path repository_root(const std::filesystem::path& directory);
+
+/// Reads the list of changed files in `path` (`-` for stdin), one per line, as given by
+/// `git diff --name-only`. Relative paths in the list are taken to be relative to `base`.
+std::vector<std::filesystem::path> read_changed_files(const std::string& path,
+                                                      const std::filesystem::path& base);
+
+/// Of `sources`, those affected by a change to any of `changed`, according to the dependencies
+/// recorded in `graph_dir` by an `include_recorder`. A source is affected if it changed itself, if
+/// it includes a file that changed, or if it has never been recorded (and so could include
+/// anything). If `changed` is not empty but none of its files is either recorded or on disk, every
+/// source is taken to be affected, with a warning.
+std::vector<std::string> affected_sources(const std::vector<std::string>& sources,
+                                          const std::vector<std::filesystem::path>& changed,
+                                          const std::filesystem::path& graph_dir,
+                                          const std::filesystem::path& src_root);
+
+/// As above, but according to the includes seen by `recorder` in this process.
+std::vector<std::string> affected_sources(const std::vector<std::string>& sources,
+                                          const std::vector<std::filesystem::path>& changed,
+                                          const include_recorder& recorder);
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
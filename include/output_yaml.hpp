@@ -13,6 +13,8 @@ written permission of Adobe.
 
 // stdc++
 #include <filesystem>
+#include <memory>
+#include <string>
 
 // application
 #include "json_fwd.hpp"
@@ -32,12 +34,54 @@ enum class yaml_mode {
 
 /**************************************************************************************************/
 
+// Puts out the documentation of one source a symbol at a time, so a symbol need not be kept once
+// it has been put out. The pages of a source file are only complete once all its symbols are in,
+// so its own page (listing its typedefs) is put out by `finish`.
+class yaml_output {
+public:
+    /// Puts out the library page. `paths` is the "paths" of the symbols of the source. With
+    /// `streaming`, each page is written as it is put out, rather than with the others at the end,
+    /// and only a summary of it is kept.
+    yaml_output(const json& paths,
+                std::filesystem::path src_root,
+                std::filesystem::path dst_root,
+                yaml_mode mode,
+                emit_options options,
+                bool streaming);
+    ~yaml_output();
+
+    yaml_output(const yaml_output&) = delete;
+    yaml_output& operator=(const yaml_output&) = delete;
+
+    /// Puts out the page of the source file, of `symbols` (the typedefs and typealiases of which
+    /// it lists).
+    void emit_sourcefile(const json& symbols);
+
+    void emit_class(const json& symbol);
+    void emit_enum(const json& symbol);
+
+    /// Puts out the page of the function `name`, which documents all of its `overloads`.
+    void emit_function(const std::string& name, const json& overloads);
+
+    /// Writes what is pending, and checks for extraneous files (see `output_yaml`).
+    /// @return What was emitted, as `output_yaml` puts it out; with `streaming`, every page in it
+    ///         is cut down to its path and title.
+    /// Throws if the documentation failed to validate.
+    json finish();
+
+private:
+    struct state;
+    std::unique_ptr<state> _state;
+};
+
+/**************************************************************************************************/
+
 void output_yaml(json j,
                  const std::filesystem::path& src_root,
                  const std::filesystem::path& dst_root,
                  json& out_emitted,
                  yaml_mode mode,
-                 const emit_options& options);
+                 emit_options options);
 
 /**************************************************************************************************/
 
@@ -0,0 +1,68 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+#pragma once
+
+// stdc++
+#include <filesystem>
+#include <memory>
+
+// clang/llvm
+// clang-format off
+#include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "_clang_include_suffix.hpp" // must be last to re-enable warnings
+// clang-format on
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+// Remembers the files the preprocessor looked for and did not find, which is most of what
+// resolving an `#include` against a long list of include directories comes to, so they are not
+// looked for again: not by later sources of a session (their file managers are not shared), and,
+// given a file to keep them in, not by later runs. What is remembered of a directory holds only as
+// long as its modification time is unchanged, as it is until a file is added to or removed from
+// it. A directory modified in the last few seconds is not remembered at all, as a file added to it
+// in the same tick of its clock would not change its time.
+class probe_cache {
+public:
+    /// Loads what `path` remembers, if it is not empty and there is anything there.
+    explicit probe_cache(std::filesystem::path path);
+    ~probe_cache();
+
+    /// A file system that looks for files in `base`, save those the cache knows are not there.
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system(
+        llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> base);
+
+    /// Takes the modification time of each directory anew when it is next needed. (They are
+    /// otherwise taken once, so files added since then are not seen.)
+    void rescan();
+
+    /// Writes what is remembered to the file it was loaded from, if anything new was learned.
+    /// Returns `true` on failure (which is reported to std::cerr), `false` otherwise.
+    bool save();
+
+private:
+    friend class probing_file_system;
+
+    struct state;
+    std::shared_ptr<state> _state; // shared with the file systems
+};
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
@@ -0,0 +1,222 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+#pragma once
+
+// stdc++
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// clang/llvm
+// clang-format off
+#include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "clang/Basic/FileManager.h"
+#include "clang/Tooling/ArgumentsAdjusters.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "_clang_include_suffix.hpp" // must be last to re-enable warnings
+// clang-format on
+
+// application
+#include "batch_io.hpp"
+#include "emitters/yaml_base_emitter_fwd.hpp"
+#include "include_graph.hpp"
+#include "json.hpp"
+#include "matchers/matcher_fwd.hpp"
+#include "probe_cache.hpp"
+#include "statistics.hpp"
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+enum class session_mode {
+    json,      // put out the JSON of the symbols in the sources
+    validate,  // see `yaml_mode`
+    update,    // see `yaml_mode`
+    transcribe // see `yaml_mode`
+};
+
+/**************************************************************************************************/
+
+// One of several outputs documented from a single parse of the sources (see
+// `session_options::_targets`).
+struct session_target {
+    session_mode _mode{session_mode::json};
+    std::filesystem::path _yaml_dir; // required unless `_mode` is `json`
+    std::filesystem::path _output;   // `json` mode only: where to write the symbols; may be empty.
+    ToolAccessFilter _access_filter{ToolAccessFilterPrivate};
+    std::vector<std::string> _namespace_blacklist;
+};
+
+/**************************************************************************************************/
+
+// Everything a session needs to know to document sources, as given by the command line (or the
+// hyde-config file) to the hyde tool.
+struct session_options {
+    session_mode _mode{session_mode::json};
+
+    // Relative paths (the sources, the roots below, and those given to clang) are taken to be
+    // relative to this directory. The process's working directory is used if it is empty; it is
+    // never changed.
+    std::filesystem::path _working_directory;
+
+    std::filesystem::path _src_root;
+    std::filesystem::path _yaml_dir; // required unless `_mode` is `json`
+
+    ToolAccessFilter _access_filter{ToolAccessFilterPrivate};
+    std::vector<std::string> _namespace_blacklist;
+    bool _process_class_methods{false};
+
+    // Match the template instantiations and implicit declarations clang synthesizes, too. They
+    // are otherwise never matched, only those spelled in the sources (see `parse`).
+    bool _document_instantiations{false};
+
+    // Which declarations to extract at all (see `ParseDeclarationFilter`). It applies to all
+    // `_targets`, too.
+    declaration_filter _filter;
+
+    // The number of threads to extract the declarations of a source with (see `ParallelExtract`),
+    // or 0 for one per core.
+    std::size_t _extraction_threads{1};
+
+    // If not empty, the sources are documented into each of these rather than according to the
+    // `_mode`, `_yaml_dir`, `_access_filter`, and `_namespace_blacklist` above. They are parsed
+    // once, keeping what the most permissive target wants, and each target is filtered from that
+    // and put out on a thread of its own.
+    std::vector<session_target> _targets;
+
+    // Put out the page of each class, enum, and function as it is extracted, and keep only a
+    // summary of it (see `yaml_output`), so the memory a source takes is bounded by its largest
+    // symbol rather than by all of them. YAML modes only.
+    bool _streaming{false};
+
+    attribute_category _tested_by{attribute_category::disabled};
+    bool _ignore_extraneous_files{false};
+    bool _use_fingerprints{false};
+
+    // Record what the extraneous file check needs (see `session_result::_checks`) instead of
+    // running it, as a sharded run must.
+    bool _defer_extraneous_file_check{false};
+
+    std::string _language;                // as given to clang's `--language`; may be empty.
+    std::vector<std::string> _clang_arguments;
+    clang::tooling::ArgumentsAdjuster _arguments_adjuster; // may be empty.
+
+    // Where to keep the include graph (see `include_recorder`); may be empty. The includes of
+    // every source are also kept in memory if this is given, or if `_record_includes` is set.
+    std::filesystem::path _include_graph;
+    bool _record_includes{false};
+
+    // Where to remember, from one run to the next, the files looked for in the include directories
+    // and not found (see `probe_cache`); may be empty, in which case they are remembered only for
+    // the life of the session.
+    std::filesystem::path _include_cache;
+
+    // How the documentation pages are read and written; falls back to `io_backend::sync` where the
+    // backend is not available.
+    io_backend _io_backend{io_backend::sync};
+
+    run_statistics* _statistics{nullptr}; // non-owning; may be null.
+};
+
+/**************************************************************************************************/
+
+struct session_result {
+    json _json;           // the symbols found (`json` mode), or the documentation emitted; with
+                          // targets, an array of what each of them put out, in order
+    shard_checks _checks; // only with `_defer_extraneous_file_check`
+};
+
+/**************************************************************************************************/
+
+// All the state hyde keeps while documenting sources. Sessions share nothing with one another (nor
+// do they change the working directory of the process), so any number of them may be run at once
+// in one process, each on its own thread.
+class session {
+public:
+    /// Throws `std::runtime_error` if the options are inconsistent.
+    explicit session(session_options options);
+    ~session();
+
+    session(const session&) = delete;
+    session& operator=(const session&) = delete;
+
+    /// Parses `sources` and puts out their documentation according to the mode. A session may
+    /// process any number of sets of sources, one after another.
+    /// Throws on failure, including (in `validate` mode) documentation that fails to validate.
+    session_result process(const std::vector<std::string>& sources);
+
+    /// Processes each of `sources` on its own, as `process({source})` would, and combines their
+    /// results. The documentation of each source is put out on a thread of its own while the
+    /// sources after it are parsed, with at most `depth` parsed sources waiting their turn, which
+    /// bounds the memory held by their symbols. Only the YAML modes can be processed this way.
+    /// A source that fails does not stop the others; once they are all done, throws if any failed
+    /// (each failure having been reported to std::cerr).
+    session_result process_each(const std::vector<std::string>& sources, std::size_t depth);
+
+    /// Every documentation file the session has created, modified, or removed.
+    const file_manifest& manifest() const { return _manifest; }
+
+    /// What every source processed so far includes, or null if includes are not being recorded.
+    const include_recorder* includes() const {
+        return _include_recorder ? &*_include_recorder : nullptr;
+    }
+
+    const session_options& options() const { return _options; }
+
+    /// `path`, if relative, taken to be relative to the working directory of the session.
+    std::filesystem::path absolute(const std::filesystem::path& path) const;
+
+private:
+    // The symbols found in `sources`, as `process` puts them out in `json` mode. With a `sink`,
+    // the classes, enums, and functions are handed to it instead (see `symbol_sink`).
+    json parse(const std::vector<std::string>& sources, const symbol_sink& sink = {});
+
+    // The "paths" of the symbols of `source`.
+    json symbol_paths(const std::string& source) const;
+
+    // How the documentation of a source is to be put out, into `out`.
+    emit_options make_emit_options(session_result& out);
+
+    // Puts out the documentation of `symbols` according to the (YAML) mode.
+    void emit(json symbols, session_result& out);
+
+    // As `process`, with `_targets`.
+    session_result process_targets(const std::vector<std::string>& sources);
+
+    // As `process`, with `_streaming`: each symbol is put out as the parse of `sources` hands it
+    // over.
+    session_result stream(const std::vector<std::string>& sources);
+
+    // Gives the parses that follow a file manager of their own to share, so the files that have
+    // changed since the last (e.g., under --watch) are seen anew.
+    void refresh_files();
+
+    session_options _options;
+    std::unique_ptr<clang::tooling::CompilationDatabase> _compilations;
+    std::optional<include_recorder> _include_recorder;
+    std::optional<probe_cache> _probe_cache;
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> _file_system;
+    llvm::IntrusiveRefCntPtr<clang::FileManager> _files; // see `refresh_files`
+    file_manifest _manifest;
+};
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
@@ -0,0 +1,75 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+#pragma once
+
+// stdc++
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// application
+#include "emitters/yaml_base_emitter_fwd.hpp"
+#include "json.hpp"
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+// Slice `_index` (1-based) of `_count` of a run's source files.
+struct shard {
+    std::size_t _index{1};
+    std::size_t _count{1};
+};
+
+/// Parses `i/N`, as given to `-hyde-shard`. Throws `std::runtime_error` if it is malformed.
+shard parse_shard(const std::string& text);
+
+/// Whether `src` belongs to shard `s`. Sources are partitioned by a stable hash of their path
+/// relative to `src_root`, so every machine splits the same source list the same way.
+bool in_shard(const std::filesystem::path& src,
+              const std::filesystem::path& src_root,
+              const shard& s);
+
+/**************************************************************************************************/
+
+// What a sharded run leaves behind for `--merge-shards`.
+struct shard_result {
+    shard _shard;
+    json _emitted; // as put out by `-hyde-emit-json`
+    shard_checks _checks;
+};
+
+/// Writes `result` to `path`. Paths in its checks are written relative to `dst_root`, so the
+/// shards may have been run with the documentation checked out anywhere.
+/// @return `true` on failure to write, `false` otherwise.
+bool write_shard_result(const shard_result& result,
+                        const std::filesystem::path& dst_root,
+                        const std::filesystem::path& path);
+
+/// Combines the results of every shard of a run into `out_merged`, one library with the
+/// sourcefiles of all the shards, and (unless `ignore_extraneous_files`) runs the extraneous file
+/// check over the documentation under `dst_root` of all of them at once.
+/// @return `true` if a result could not be read, a shard is missing or has more than one result,
+///         or there are extraneous files; `false` otherwise.
+bool merge_shards(const std::vector<std::filesystem::path>& results,
+                  const std::filesystem::path& dst_root,
+                  bool ignore_extraneous_files,
+                  json& out_merged);
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
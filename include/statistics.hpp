@@ -0,0 +1,113 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+#pragma once
+
+// stdc++
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <utility>
+
+// application
+#include "emitters/yaml_base_emitter_fwd.hpp"
+#include "matchers/matcher_fwd.hpp"
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+struct cpu_time {
+    double _wall{0};   // seconds
+    double _user{0};   // seconds
+    double _system{0}; // seconds
+
+    cpu_time& operator+=(const cpu_time& x) {
+        _wall += x._wall;
+        _user += x._user;
+        _system += x._system;
+        return *this;
+    }
+
+    cpu_time& operator-=(const cpu_time& x) {
+        _wall -= x._wall;
+        _user -= x._user;
+        _system -= x._system;
+        return *this;
+    }
+};
+
+/// The time spent by this process so far.
+cpu_time current_cpu_time();
+
+/// The peak resident set size of this process so far, or zero if it cannot be determined.
+std::uint64_t peak_rss_bytes();
+
+/**************************************************************************************************/
+
+struct matcher_statistics {
+    std::size_t _visited{0};  // declarations of the matcher's kind, before any check
+    std::size_t _accepted{0}; // declarations it documented
+    cpu_time _time;           // time spent in the matcher's callback
+};
+
+/**************************************************************************************************/
+
+// Counters describing a single run of hyde, written out with `-hyde-stats`.
+struct run_statistics {
+    std::string _source;
+    std::string _mode;
+    std::map<std::string, cpu_time> _phases;
+    std::map<std::string, matcher_statistics> _matchers;
+    rejection_counts _rejections;
+    page_statistics _pages;
+};
+
+/// Writes `statistics` to `path`. Paths ending in `.prom` get the Prometheus text format read by
+/// the node_exporter textfile collector; everything else gets JSON.
+/// @return `true` on failure to write, `false` otherwise.
+bool write_statistics(const run_statistics& statistics, const std::filesystem::path& path);
+
+/**************************************************************************************************/
+
+// Adds the time spent during its lifetime to a phase of a run. Does nothing without statistics.
+class phase_timer {
+public:
+    phase_timer(run_statistics* statistics, std::string phase)
+        : _statistics(statistics), _phase(std::move(phase)) {
+        if (_statistics) _start = current_cpu_time();
+    }
+
+    ~phase_timer() {
+        if (!_statistics) return;
+        cpu_time elapsed = current_cpu_time();
+        elapsed -= _start;
+        _statistics->_phases[_phase] += elapsed;
+    }
+
+    phase_timer(const phase_timer&) = delete;
+    phase_timer& operator=(const phase_timer&) = delete;
+
+private:
+    run_statistics* _statistics;
+    std::string _phase;
+    cpu_time _start;
+};
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
@@ -0,0 +1,53 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+#pragma once
+
+// stdc++
+#include <string>
+#include <vector>
+
+// application
+#include "json.hpp"
+#include "session.hpp"
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+/// Parses a target as given to `-hyde-target`: comma-separated `key=value` fields, of which `mode`
+/// (`json`, `validate`, `update`, or `transcribe`) is required, and `yaml-dir`, `output`, `access`
+/// (`private`, `protected`, or `public`), and `namespace-blacklist` (which may be repeated) are
+/// optional. Fields that are not given are taken from `defaults`.
+/// Throws `std::runtime_error` if it is malformed.
+session_target parse_target(const std::string& text, const session_target& defaults);
+
+/// A short description of `target`, to tell it from the others in diagnostics.
+std::string to_string(const session_target& target);
+
+/// The settings to extract symbols with so that every one of `targets` can be filtered from them:
+/// the most permissive access filter among them, and the namespaces all of them blacklist.
+ToolAccessFilter extraction_access_filter(const std::vector<session_target>& targets);
+std::vector<std::string> extraction_namespace_blacklist(const std::vector<session_target>& targets);
+
+/// `symbols` (as put out in `json` mode) without what `access_filter` and `namespace_blacklist`
+/// exclude, as if they had been extracted with them.
+json filter_symbols(json symbols,
+                    ToolAccessFilter access_filter,
+                    const std::vector<std::string>& namespace_blacklist);
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
@@ -0,0 +1,70 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+#pragma once
+
+// stdc++
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+// Reports changes to a set of files, in batches. It is backed by inotify, so it is only available
+// on Linux; elsewhere, constructing one throws.
+class file_watcher {
+public:
+    file_watcher();
+    ~file_watcher();
+
+    file_watcher(const file_watcher&) = delete;
+    file_watcher& operator=(const file_watcher&) = delete;
+
+    /// Reports changes to `path` (which need not exist yet) from now on. It is the directory of
+    /// `path` that is watched, as many editors save by writing a new file and renaming it into
+    /// place, which would end a watch on the file itself.
+    void watch(const std::filesystem::path& path);
+
+    /// The number of files being watched.
+    std::size_t size() const { return _files.size(); }
+
+    /// Blocks until a watched file is written, created, removed, or replaced, then collects any
+    /// further changes until none have come for `quiet`.
+    /// @return The files that changed, each once, or `std::nullopt` if interrupted by SIGINT or
+    ///         SIGTERM.
+    std::optional<std::vector<std::filesystem::path>> wait(std::chrono::milliseconds quiet);
+
+private:
+    int _fd{-1};
+    std::unordered_map<int, std::filesystem::path> _directories; // by watch descriptor
+    std::unordered_map<std::string, int> _descriptors;           // by directory
+    std::unordered_set<std::string> _files;
+};
+
+/**************************************************************************************************/
+
+/// Replaces this process with a new run of it, with the arguments `argv`. Throws if that cannot be
+/// done.
+[[noreturn]] void restart_process(const char** argv);
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
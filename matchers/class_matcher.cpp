@@ -14,6 +14,7 @@ written permission of Adobe.
 
 // stdc++
 #include <iostream>
+#include <mutex>
 
 // clang/llvm
 // clang-format off
@@ -22,6 +23,7 @@ written permission of Adobe.
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "_clang_include_suffix.hpp" // must be last to re-enable warnings
 // clang-format on
 
@@ -69,7 +71,10 @@ public:
     FindStaticMembers(const hyde::processing_options& options)
         : _options(options), _static_members(hyde::json::object()) {}
     bool VisitVarDecl(const VarDecl* d) {
-        if (!AccessCheck(_options._access_filter, d->getAccess())) return true;
+        if (!AccessCheck(_options._access_filter, d->getAccess())) {
+            if (_options._rejections) ++_options._rejections->_access;
+            return true;
+        }
 
         auto storage = d->getStorageClass();
         // TODO(Wyles): Do we want to worry about other kinds of storage?
@@ -129,46 +134,39 @@ json fixup_short_name(json&& method) {
 
 /**************************************************************************************************/
 
-void ClassInfo::run(const MatchFinder::MatchResult& Result) {
-    auto clas = Result.Nodes.getNodeAs<CXXRecordDecl>("class");
-
-    if (!clas->isCompleteDefinition()) return; // e.g., a forward declaration.
-
-    if (clas->isLambda()) return;
-
-    if (!clas->getSourceRange().isValid()) return; // e.g., compiler-injected class specialization
-
-    // e.g., compiler-injected class specializations not caught by the above
-    if (auto s = llvm::dyn_cast_or_null<ClassTemplateSpecializationDecl>(clas)) {
-        if (!s->getTypeAsWritten()) return;
-    }
+optional_json DetailClass(const processing_options& options, const CXXRecordDecl* clas) {
+    llvm::TimeTraceScope trace("MatchClass", [&] { return TraceDetail(clas); });
 
-    auto info_opt = DetailCXXRecordDecl(_options, clas);
-    if (!info_opt) return;
+    auto info_opt = DetailCXXRecordDecl(options, clas);
+    if (!info_opt) return info_opt;
     auto info = std::move(*info_opt);
 
-    if (NamespaceBlacklist(_options._namespace_blacklist, info)) return;
+    if (NamespaceBlacklist(options._namespace_blacklist, info)) return std::nullopt;
 
     info["kind"] = clas->getKindName();
     info["methods"] = json::object();
 
     FindConstructor ctor_finder;
-    ctor_finder.TraverseDecl(const_cast<Decl*>(static_cast<const Decl*>(clas)));
-    if (!ctor_finder) info["ctor"] = "unspecified";
-
     FindDestructor dtor_finder;
-    dtor_finder.TraverseDecl(const_cast<Decl*>(static_cast<const Decl*>(clas)));
-    if (!dtor_finder) info["dtor"] = "unspecified";
+    FindStaticMembers static_finder(options);
+
+    {
+        // Traversal can build the lookup tables of what it traverses (e.g., those of lambdas).
+        std::lock_guard<std::recursive_mutex> lock(ASTMutex());
+        ctor_finder.TraverseDecl(const_cast<Decl*>(static_cast<const Decl*>(clas)));
+        dtor_finder.TraverseDecl(const_cast<Decl*>(static_cast<const Decl*>(clas)));
+        static_finder.TraverseDecl(const_cast<Decl*>(static_cast<const Decl*>(clas)));
+    }
 
-    FindStaticMembers static_finder(_options);
-    static_finder.TraverseDecl(const_cast<Decl*>(static_cast<const Decl*>(clas)));
+    if (!ctor_finder) info["ctor"] = "unspecified";
+    if (!dtor_finder) info["dtor"] = "unspecified";
 
     if (const auto& template_decl = clas->getDescribedClassTemplate()) {
-        info["template_parameters"] = GetTemplateParameters(Result.Context, template_decl);
+        info["template_parameters"] = GetTemplateParameters(&clas->getASTContext(), template_decl);
     }
 
     for (const auto& method : clas->methods()) {
-        auto methodInfo_opt = DetailFunctionDecl(_options, method);
+        auto methodInfo_opt = DetailFunctionDecl(options, method);
         if (!methodInfo_opt) continue;
         auto methodInfo = std::move(*methodInfo_opt);
         methodInfo = fixup_short_name(std::move(methodInfo));
@@ -180,7 +178,7 @@ void ClassInfo::run(const MatchFinder::MatchResult& Result) {
         auto* function_template_decl = dyn_cast<FunctionTemplateDecl>(decl);
         if (!function_template_decl) continue;
         auto methodInfo_opt =
-            DetailFunctionDecl(_options, function_template_decl->getTemplatedDecl());
+            DetailFunctionDecl(options, function_template_decl->getTemplatedDecl());
         if (!methodInfo_opt) continue;
         auto methodInfo = std::move(*methodInfo_opt);
         methodInfo = fixup_short_name(std::move(methodInfo));
@@ -189,7 +187,7 @@ void ClassInfo::run(const MatchFinder::MatchResult& Result) {
     }
 
     for (const auto& field : clas->fields()) {
-        auto fieldInfo_opt = StandardDeclInfo(_options, field);
+        auto fieldInfo_opt = StandardDeclInfo(options, field);
         if (!fieldInfo_opt) continue;
         auto fieldInfo = std::move(*fieldInfo_opt);
         fieldInfo["type"] = hyde::to_string(field, field->getType());
@@ -212,7 +210,7 @@ void ClassInfo::run(const MatchFinder::MatchResult& Result) {
                            typedef_iterator(CXXRecordDecl::decl_iterator()));
     for (const auto& type_def : typedefs) {
         // REVISIT (fbrereto) : Refactor this block and TypedefInfo::run's.
-        auto typedefInfo_opt = StandardDeclInfo(_options, type_def);
+        auto typedefInfo_opt = StandardDeclInfo(options, type_def);
         if (!typedefInfo_opt) continue;
         auto typedefInfo = std::move(*typedefInfo_opt);
 
@@ -227,20 +225,42 @@ void ClassInfo::run(const MatchFinder::MatchResult& Result) {
                                 typealias_iterator(CXXRecordDecl::decl_iterator()));
     for (const auto& type_alias : typealiases) {
         // REVISIT (fbrereto) : Refactor this block and TypeAliasInfo::run's.
-        auto typealiasInfo_opt = StandardDeclInfo(_options, type_alias);
+        auto typealiasInfo_opt = StandardDeclInfo(options, type_alias);
         if (!typealiasInfo_opt) continue;
         auto typealiasInfo = std::move(*typealiasInfo_opt);
 
         typealiasInfo["type"] = hyde::to_string(type_alias, type_alias->getUnderlyingType());
         if (auto template_decl = type_alias->getDescribedAliasTemplate()) {
             typealiasInfo["template_parameters"] =
-                GetTemplateParameters(Result.Context, template_decl);
+                GetTemplateParameters(&clas->getASTContext(), template_decl);
         }
 
         info["typealiases"].push_back(std::move(typealiasInfo));
     }
 
-    _j["classes"].push_back(std::move(info));
+    return info;
+}
+
+/**************************************************************************************************/
+
+void ClassInfo::run(const MatchFinder::MatchResult& Result) {
+    // Forward declarations and the like have already been turned away (see `GetChecks`).
+    _decls.push_back(Result.Nodes.getNodeAs<CXXRecordDecl>("class"));
+}
+
+/**************************************************************************************************/
+
+void ClassInfo::onEndOfTranslationUnit() {
+    llvm::TimeTraceScope trace("ExtractClasses");
+    ExtractEach(_options, _decls, &DetailClass, [&](json info) {
+        if (_options._sink) {
+            _options._sink("classes", std::move(info));
+        } else {
+            _j["classes"].push_back(std::move(info));
+        }
+    });
+
+    _decls.clear();
 }
 
 /**************************************************************************************************/
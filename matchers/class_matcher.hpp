@@ -11,6 +11,9 @@ written permission of Adobe.
 
 #pragma once
 
+// stdc++
+#include <vector>
+
 // clang/llvm
 // clang-format off
 #include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
@@ -30,6 +33,25 @@ using namespace clang::ast_matchers;
 
 namespace hyde {
 
+/**************************************************************************************************/
+// Whether the class is one to document, rather than a forward declaration, a lambda, or a class
+// the compiler made up.
+AST_MATCHER(CXXRecordDecl, isDocumentableClass) {
+    if (!Node.isCompleteDefinition()) return false; // e.g., a forward declaration.
+
+    if (Node.isLambda()) return false;
+
+    // e.g., compiler-injected class specialization
+    if (!Node.getSourceRange().isValid()) return false;
+
+    // e.g., compiler-injected class specializations not caught by the above
+    if (auto s = llvm::dyn_cast<ClassTemplateSpecializationDecl>(&Node)) {
+        if (!s->getTypeAsWritten()) return false;
+    }
+
+    return true;
+}
+
 /**************************************************************************************************/
 
 class ClassInfo : public MatchFinder::MatchCallback {
@@ -40,13 +62,21 @@ public:
 
     void run(const MatchFinder::MatchResult& Result) override;
 
+    void onEndOfTranslationUnit() override;
+
     json getJSON() { return _j; }
 
     static DeclarationMatcher GetMatcher() { return cxxRecordDecl().bind("class"); }
 
+    /// What a class has to be to be documented, checked before any filter: a complete definition,
+    /// and one spelled out in the source.
+    static DeclarationMatcher GetChecks() { return cxxRecordDecl(isDocumentableClass()); }
+
 private:
     processing_options _options;
     json _j;
+    // Matched, and extracted (see `ParallelExtract`) at the end of the translation unit.
+    std::vector<const CXXRecordDecl*> _decls;
 };
 
 /**************************************************************************************************/
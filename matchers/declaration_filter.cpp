@@ -0,0 +1,279 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+// identity
+#include "declaration_filter.hpp"
+
+// stdc++
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// clang/llvm
+// clang-format off
+#include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "clang/AST/ASTContext.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Regex.h"
+#include "_clang_include_suffix.hpp" // must be last to re-enable warnings
+// clang-format on
+
+// application
+#include "matchers/utilities.hpp"
+
+using namespace clang::ast_matchers;
+
+/**************************************************************************************************/
+
+namespace {
+
+/**************************************************************************************************/
+
+constexpr std::string_view kinds_k[] = {"functions",  "enums",       "classes",
+                                        "namespaces", "typealiases", "typedefs"};
+
+/**************************************************************************************************/
+
+[[noreturn]] void invalid(const std::string& why) {
+    throw std::runtime_error("invalid hyde-filter: " + why);
+}
+
+/**************************************************************************************************/
+// The strings of `spec[key]`, which must be an array of them if it is there at all.
+std::vector<std::string> strings(const hyde::json& spec, const char* key) {
+    std::vector<std::string> result;
+
+    if (!spec.count(key)) return result;
+
+    const auto& values = spec[key];
+
+    if (!values.is_array()) invalid(std::string("`") + key + "` is not an array");
+
+    for (const auto& value : values) {
+        if (!value.is_string()) invalid(std::string("`") + key + "` holds a non-string");
+        result.push_back(value.get<std::string>());
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+void check_regex(const std::string& regex) {
+    std::string error;
+
+    if (!llvm::Regex(regex).isValid(error)) invalid("`" + regex + "`: " + error);
+}
+
+/**************************************************************************************************/
+// `glob` as an (extended POSIX) regular expression of the qualified names (with a leading `::`, as
+// `matchesName` sees them) of the namespaces it matches.
+std::string glob_regex(std::string_view glob) {
+    const bool qualified = glob.find("::") != std::string_view::npos;
+
+    if (glob.substr(0, 2) == "::") glob.remove_prefix(2);
+
+    std::string result(qualified ? "^::" : "::");
+
+    for (std::size_t i = 0; i < glob.size(); ++i) {
+        const char c = glob[i];
+
+        if (c == '*' && i + 1 < glob.size() && glob[i + 1] == '*') {
+            result += ".*";
+            ++i;
+        } else if (c == '*') {
+            result += "[^:]*";
+        } else if (c == '?') {
+            result += "[^:]";
+        } else {
+            if (std::string_view(".^$|()[]{}+\\").find(c) != std::string_view::npos) result += '\\';
+            result += c;
+        }
+    }
+
+    return result + '$';
+}
+
+/**************************************************************************************************/
+// One regular expression that matches what any of `regexes` does.
+std::string any_of(const std::vector<std::string>& regexes) {
+    std::string result;
+
+    for (const auto& regex : regexes) {
+        if (!result.empty()) result += '|';
+        result += '(' + regex + ')';
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+std::vector<std::string> glob_regexes(const std::vector<std::string>& globs) {
+    std::vector<std::string> result;
+
+    for (const auto& glob : globs) {
+        result.push_back(glob_regex(glob));
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+// Declarations that are, or are in, a namespace matching `regex`.
+DeclarationMatcher in_namespace(const std::string& regex) {
+    return anyOf(namespaceDecl(matchesName(regex)), hasAncestor(namespaceDecl(matchesName(regex))));
+}
+
+/**************************************************************************************************/
+// Declarations spelled in one of `paths`, as `PathCheck` has them.
+AST_MATCHER_P(clang::Decl, inPaths, std::vector<std::string>, paths) {
+    return hyde::PathCheck(paths, &Node, &Finder->getASTContext());
+}
+
+/**************************************************************************************************/
+// What `inner` matches, counting those it turns away in `*count` (unless it is null), as the
+// checks of `StandardDeclInfo` count theirs.
+AST_MATCHER_P2(clang::Decl, counting, DeclarationMatcher, inner, std::size_t*, count) {
+    if (inner.matches(Node, Finder, Builder)) return true;
+    if (count) ++*count;
+    return false;
+}
+
+/**************************************************************************************************/
+
+} // namespace
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+declaration_filter ParseDeclarationFilter(const json& spec) {
+    declaration_filter result;
+
+    if (spec.is_null()) return result;
+
+    if (!spec.is_object()) invalid("not an object");
+
+    for (auto it = spec.begin(); it != spec.end(); ++it) {
+        const auto& key = it.key();
+        if (key != "namespaces" && key != "names" && key != "access" && key != "skip")
+            invalid("unknown key `" + key + "`");
+    }
+
+    const json none = json::object();
+    const json& namespaces = spec.count("namespaces") ? spec["namespaces"] : none;
+    const json& names = spec.count("names") ? spec["names"] : none;
+
+    if (!namespaces.is_object()) invalid("`namespaces` is not an object");
+    if (!names.is_object()) invalid("`names` is not an object");
+
+    result._namespace_allow = strings(namespaces, "allow");
+    result._namespace_deny = strings(namespaces, "deny");
+    result._name_allow = strings(names, "allow");
+    result._name_deny = strings(names, "deny");
+    result._skip = strings(spec, "skip");
+
+    for (const auto& regex : result._name_allow) check_regex(regex);
+    for (const auto& regex : result._name_deny) check_regex(regex);
+
+    for (const auto& kind : result._skip) {
+        if (std::find(std::begin(kinds_k), std::end(kinds_k), kind) == std::end(kinds_k))
+            invalid("unknown kind to skip `" + kind + "`");
+    }
+
+    if (spec.count("access")) {
+        const json& access = spec["access"];
+        if (access == "private") {
+            result._access_filter = ToolAccessFilterPrivate;
+        } else if (access == "protected") {
+            result._access_filter = ToolAccessFilterProtected;
+        } else if (access == "public") {
+            result._access_filter = ToolAccessFilterPublic;
+        } else {
+            invalid("unknown access `" + access.dump() + "`");
+        }
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+DeclarationMatcher FilterMatcher(const processing_options& options) {
+    const declaration_filter& filter = options._filter;
+    rejection_counts* const rejections = options._rejections;
+
+    // The checks are made in order, the cheapest first. Most declarations come from headers that
+    // are not being documented, so that check turns them away before any name is looked at.
+    DeclarationMatcher result =
+        counting(inPaths(options._paths), rejections ? &rejections->_path : nullptr);
+
+    // As `NamespaceBlacklist` checks them: the namespaces a declaration is in, but not itself.
+    std::vector<llvm::StringRef> blacklist;
+
+    for (const auto& ns : options._namespace_blacklist) {
+        if (!ns.empty()) blacklist.push_back(ns);
+    }
+
+    if (!blacklist.empty()) {
+        result = decl(result, counting(unless(hasAncestor(namespaceDecl(hasAnyName(blacklist)))),
+                                       rejections ? &rejections->_namespace : nullptr));
+    }
+
+    // As `AccessCheck` does. Declarations without an access specifier are never private or
+    // protected.
+    std::size_t* const access = rejections ? &rejections->_access : nullptr;
+
+    switch (std::max(options._access_filter, filter._access_filter)) {
+        case ToolAccessFilterPrivate:
+            break;
+        case ToolAccessFilterProtected:
+            result = decl(result, counting(unless(isPrivate()), access));
+            break;
+        case ToolAccessFilterPublic:
+            result = decl(result, counting(unless(anyOf(isPrivate(), isProtected())), access));
+            break;
+    }
+
+    if (!filter._namespace_allow.empty()) {
+        result = decl(result, in_namespace(any_of(glob_regexes(filter._namespace_allow))));
+    }
+
+    if (!filter._namespace_deny.empty()) {
+        result = decl(result, unless(in_namespace(any_of(glob_regexes(filter._namespace_deny)))));
+    }
+
+    if (!filter._name_allow.empty()) {
+        result = decl(result, namedDecl(matchesName(any_of(filter._name_allow))));
+    }
+
+    if (!filter._name_deny.empty()) {
+        result = decl(result, unless(namedDecl(matchesName(any_of(filter._name_deny)))));
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+bool FilterSkips(const declaration_filter& filter, std::string_view kind) {
+    return std::find(filter._skip.begin(), filter._skip.end(), kind) != filter._skip.end();
+}
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
@@ -0,0 +1,64 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+#pragma once
+
+// stdc++
+#include <string_view>
+
+// clang/llvm
+// clang-format off
+#include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "clang/ASTMatchers/ASTMatchers.h"
+#include "_clang_include_suffix.hpp" // must be last to re-enable warnings
+// clang-format on
+
+// application
+#include "json.hpp"
+#include "matchers/matcher_fwd.hpp"
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+/// Parses the `hyde-filter` object of a hyde-config file, every key of which is optional:
+///
+///     {
+///         "namespaces": { "allow": [<glob>...], "deny": [<glob>...] },
+///         "names": { "allow": [<regex>...], "deny": [<regex>...] },
+///         "access": "private" | "protected" | "public",
+///         "skip": [<kind>...]
+///     }
+///
+/// where each `<kind>` is one of "functions", "enums", "classes", "namespaces", "typealiases", or
+/// "typedefs".
+///
+/// Throws `std::runtime_error` if it is malformed.
+declaration_filter ParseDeclarationFilter(const json& spec);
+
+/// The declarations in `options._paths` let through by `options._filter`,
+/// `options._access_filter`, and `options._namespace_blacklist`, as a matcher to narrow those of
+/// each of the matchers with. It is cheaper to turn a declaration away here than once it has been
+/// detailed, where `PathCheck`, `AccessCheck`, and `NamespaceBlacklist` apply them (as they still
+/// do, to the members of classes). Those turned away by the path, access, and namespace blacklist
+/// checks are counted in `options._rejections`, as they would have been there.
+clang::ast_matchers::DeclarationMatcher FilterMatcher(const processing_options& options);
+
+/// Whether the matcher of `kind` symbols ("functions", "classes", ...) is not to be run at all.
+bool FilterSkips(const declaration_filter& filter, std::string_view kind);
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
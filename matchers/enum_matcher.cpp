@@ -21,6 +21,7 @@ written permission of Adobe.
 #include "clang/AST/ASTConsumer.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "_clang_include_suffix.hpp" // must be last to re-enable warnings
 // clang-format on
 
@@ -37,10 +38,10 @@ namespace hyde {
 
 /**************************************************************************************************/
 
-void EnumInfo::run(const MatchFinder::MatchResult& Result) {
-    auto enumeration = Result.Nodes.getNodeAs<EnumDecl>("enum");
-    auto info_opt = StandardDeclInfo(_options, enumeration);
-    if (!info_opt) return;
+optional_json DetailEnumDecl(const processing_options& options, const EnumDecl* enumeration) {
+    llvm::TimeTraceScope trace("MatchEnum", [&] { return TraceDetail(enumeration); });
+    auto info_opt = StandardDeclInfo(options, enumeration);
+    if (!info_opt) return info_opt;
     auto info = std::move(*info_opt);
 
     // info["scoped"] = enumeration->isScoped();
@@ -53,14 +54,35 @@ void EnumInfo::run(const MatchFinder::MatchResult& Result) {
 
         enumerator["name"] = p->getNameAsString();
 
-        if (auto comments = ProcessComments(p)) {
+        if (auto comments = ProcessComments(options, p)) {
             enumerator["comments"] = std::move(*comments);
         }
 
         info["values"].push_back(std::move(enumerator));
     }
 
-    _j["enums"].push_back(std::move(info));
+    return info;
+}
+
+/**************************************************************************************************/
+
+void EnumInfo::run(const MatchFinder::MatchResult& Result) {
+    _decls.push_back(Result.Nodes.getNodeAs<EnumDecl>("enum"));
+}
+
+/**************************************************************************************************/
+
+void EnumInfo::onEndOfTranslationUnit() {
+    llvm::TimeTraceScope trace("ExtractEnums");
+    ExtractEach(_options, _decls, &DetailEnumDecl, [&](json info) {
+        if (_options._sink) {
+            _options._sink("enums", std::move(info));
+        } else {
+            _j["enums"].push_back(std::move(info));
+        }
+    });
+
+    _decls.clear();
 }
 
 /**************************************************************************************************/
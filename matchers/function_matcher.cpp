@@ -22,6 +22,7 @@ written permission of Adobe.
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
 #include "clang/Lex/Lexer.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "_clang_include_suffix.hpp" // must be last to re-enable warnings
 // clang-format on
 
@@ -39,23 +40,34 @@ namespace hyde {
 /**************************************************************************************************/
 
 void FunctionInfo::run(const MatchFinder::MatchResult& Result) {
-    auto function = Result.Nodes.getNodeAs<FunctionDecl>("func");
+    // Class methods have already been turned away (see `GetChecks`), unless they are wanted.
+    _decls.push_back(Result.Nodes.getNodeAs<FunctionDecl>("func"));
+}
 
-    // Do not process class methods here.
-    if (!_options._process_class_methods) {
-        if (llvm::dyn_cast_or_null<CXXMethodDecl>(function)) return;
-    }
+/**************************************************************************************************/
 
-    auto info_opt = DetailFunctionDecl(_options, function);
-    if (!info_opt) return;
-    auto info = std::move(*info_opt);
+void FunctionInfo::onEndOfTranslationUnit() {
+    llvm::TimeTraceScope trace("ExtractFunctions");
+    const auto extract = [](const processing_options& options, const FunctionDecl* function) {
+        llvm::TimeTraceScope trace("MatchFunction", [&] { return TraceDetail(function); });
+        return DetailFunctionDecl(options, function);
+    };
 
-    const std::string& short_name(info["short_name"]);
+    ExtractEach(_options, _decls, extract, [&](json info) {
+        const std::string& short_name(info["short_name"]);
+        _j["functions"][short_name].push_back(std::move(info));
+    });
 
-    // Omit compiler-reserved functions
-    if (short_name.find("__") == 0) return;
+    _decls.clear();
 
-    _j["functions"][short_name].push_back(std::move(info));
+    // Overloads are documented together, so a function is only complete once all are extracted.
+    if (_options._sink && _j.count("functions")) {
+        for (auto& overloads : _j["functions"]) {
+            _options._sink("functions", std::move(overloads));
+        }
+
+        _j.erase("functions");
+    }
 }
 
 /**************************************************************************************************/
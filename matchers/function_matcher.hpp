@@ -11,6 +11,9 @@ written permission of Adobe.
 
 #pragma once
 
+// stdc++
+#include <vector>
+
 // clang/llvm
 // clang-format off
 #include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
@@ -30,6 +33,14 @@ using namespace clang::ast_matchers;
 
 namespace hyde {
 
+/**************************************************************************************************/
+// Compiler-reserved names (e.g., `__builtin_expect`) begin with two underscores. Only identifiers
+// can be reserved this way: operators, conversions, and the like have none, and are never matched.
+AST_MATCHER(NamedDecl, hasReservedName) {
+    const IdentifierInfo* identifier = Node.getIdentifier();
+    return identifier && identifier->getName().starts_with("__");
+}
+
 /**************************************************************************************************/
 
 class FunctionInfo : public MatchFinder::MatchCallback {
@@ -40,13 +51,25 @@ public:
 
     void run(const MatchFinder::MatchResult& Result) override;
 
+    void onEndOfTranslationUnit() override;
+
     json getJSON() { return _j; }
 
     static DeclarationMatcher GetMatcher() { return functionDecl().bind("func"); }
 
+    /// What a function has to be to be documented here, checked before any filter: class methods
+    /// are documented with their classes (unless they are to be processed here, too), and
+    /// compiler-reserved functions are not documented at all.
+    static DeclarationMatcher GetChecks(const processing_options& options) {
+        if (options._process_class_methods) return functionDecl(unless(hasReservedName()));
+        return functionDecl(unless(hasReservedName()), unless(cxxMethodDecl()));
+    }
+
 private:
     processing_options _options;
     json _j;
+    // Matched, and extracted (see `ParallelExtract`) at the end of the translation unit.
+    std::vector<const FunctionDecl*> _decls;
 };
 
 /**************************************************************************************************/
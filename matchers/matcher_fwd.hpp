@@ -12,9 +12,15 @@ written permission of Adobe.
 #pragma once
 
 // stdc++
+#include <cstddef>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <vector>
 
+// application
+#include "json_fwd.hpp"
+
 /**************************************************************************************************/
 
 namespace hyde {
@@ -29,11 +35,52 @@ enum ToolAccessFilter {
 
 /**************************************************************************************************/
 
+// The number of declarations turned away by each of the checks the matchers apply.
+struct rejection_counts {
+    std::size_t _path{0};      // not in one of the files being processed (`PathCheck`)
+    std::size_t _access{0};    // excluded by the access filter (`AccessCheck`)
+    std::size_t _namespace{0}; // in a blacklisted namespace (`NamespaceBlacklist`)
+};
+
+/**************************************************************************************************/
+
+// Which declarations the matchers consider at all, as given under `hyde-filter` in the hyde-config
+// file (see `ParseDeclarationFilter`). It is compiled into the matchers themselves (see
+// `FilterMatcher`), so the declarations it excludes are never detailed.
+struct declaration_filter {
+    // Globs (`*` matching within a name, `**` across `::`) of namespaces. A glob without `::` is
+    // matched against the name of each namespace, and one with it against qualified names.
+    std::vector<std::string> _namespace_allow; // if any, only declarations in (or of) these
+    std::vector<std::string> _namespace_deny;  // none in (or of) these
+    // Regular expressions, searched for in qualified names (with a leading `::`).
+    std::vector<std::string> _name_allow; // if any, only declarations named by one of these
+    std::vector<std::string> _name_deny;  // none named by these
+    // The stricter of this and the access filter of the processing options applies.
+    ToolAccessFilter _access_filter{ToolAccessFilterPrivate};
+    std::vector<std::string> _skip; // kinds ("functions", "classes", ...) not to match at all
+};
+
+/**************************************************************************************************/
+
+// Takes the symbols that have pages of their own as they are extracted, rather than leaving them
+// to be collected from the matchers at the end: each class or enum (`kind` being "classes" or
+// "enums") on its own, and each function with all its overloads ("functions", as an array).
+using symbol_sink = std::function<void(std::string_view kind, json symbol)>;
+
+/**************************************************************************************************/
+
 struct processing_options {
     std::vector<std::string> _paths;
     ToolAccessFilter _access_filter;
     std::vector<std::string> _namespace_blacklist;
     bool _process_class_methods;
+    rejection_counts* _rejections{nullptr}; // non-owning; may be null.
+    std::size_t _extraction_threads{1};     // see `ParallelExtract`
+    symbol_sink _sink;                      // may be empty.
+    declaration_filter _filter;
+    // Convert only the parts of doc comments the YAML emitters read (see `ProcessComments`), when
+    // no one is to see the symbols themselves.
+    bool _emitted_comments_only{false};
 };
 
 /**************************************************************************************************/
@@ -21,6 +21,7 @@ written permission of Adobe.
 #include "clang/AST/ASTConsumer.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "_clang_include_suffix.hpp" // must be last to re-enable warnings
 // clang-format on
 
@@ -38,12 +39,24 @@ namespace hyde {
 /**************************************************************************************************/
 
 void NamespaceInfo::run(const MatchFinder::MatchResult& Result) {
-    auto ns = Result.Nodes.getNodeAs<NamespaceDecl>("ns");
-    auto info_opt = StandardDeclInfo(_options, ns);
-    if (!info_opt) return;
-    auto info = std::move(*info_opt);
+    _decls.push_back(Result.Nodes.getNodeAs<NamespaceDecl>("ns"));
+}
+
+/**************************************************************************************************/
+
+void NamespaceInfo::onEndOfTranslationUnit() {
+    llvm::TimeTraceScope trace("ExtractNamespaces");
+    auto extracted = ParallelExtract(
+        _options, _decls, [](const processing_options& options, const NamespaceDecl* ns) {
+            llvm::TimeTraceScope trace("MatchNamespace", [&] { return TraceDetail(ns); });
+            return StandardDeclInfo(options, ns);
+        });
+
+    _decls.clear();
 
-    _j["namespaces"].push_back(std::move(info));
+    for (auto& info : extracted) {
+        if (info) _j["namespaces"].push_back(std::move(*info));
+    }
 }
 
 /**************************************************************************************************/
@@ -21,6 +21,7 @@ written permission of Adobe.
 #include "clang/AST/ASTConsumer.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "_clang_include_suffix.hpp" // must be last to re-enable warnings
 // clang-format on
 
@@ -37,23 +38,42 @@ namespace hyde {
 
 /**************************************************************************************************/
 
-void TypeAliasInfo::run(const MatchFinder::MatchResult& Result) {
-    auto node = Result.Nodes.getNodeAs<TypeAliasDecl>("typealias");
+optional_json DetailTypeAliasDecl(const processing_options& options, const TypeAliasDecl* node) {
+    llvm::TimeTraceScope trace("MatchTypeAlias", [&] { return TraceDetail(node); });
 
-    auto info_opt = StandardDeclInfo(_options, node);
-    if (!info_opt) return;
+    auto info_opt = StandardDeclInfo(options, node);
+    if (!info_opt) return info_opt;
     auto info = std::move(*info_opt);
 
     // do not process class type aliases here.
-    if (!info["parents"].empty()) return;
+    if (!info["parents"].empty()) return std::nullopt;
 
     info["type"] = hyde::to_string(node, node->getUnderlyingType());
 
     if (auto template_decl = node->getDescribedAliasTemplate()) {
-        info["template_parameters"] = GetTemplateParameters(Result.Context, template_decl);
+        info["template_parameters"] = GetTemplateParameters(&node->getASTContext(), template_decl);
     }
 
-    _j["typealiases"].push_back(std::move(info));
+    return info;
+}
+
+/**************************************************************************************************/
+
+void TypeAliasInfo::run(const MatchFinder::MatchResult& Result) {
+    _decls.push_back(Result.Nodes.getNodeAs<TypeAliasDecl>("typealias"));
+}
+
+/**************************************************************************************************/
+
+void TypeAliasInfo::onEndOfTranslationUnit() {
+    llvm::TimeTraceScope trace("ExtractTypeAliases");
+    auto extracted = ParallelExtract(_options, _decls, &DetailTypeAliasDecl);
+
+    _decls.clear();
+
+    for (auto& info : extracted) {
+        if (info) _j["typealiases"].push_back(std::move(*info));
+    }
 }
 
 /**************************************************************************************************/
@@ -11,6 +11,9 @@ written permission of Adobe.
 
 #pragma once
 
+// stdc++
+#include <vector>
+
 // clang/llvm
 // clang-format off
 #include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
@@ -40,6 +43,8 @@ public:
 
     void run(const MatchFinder::MatchResult& Result) override;
 
+    void onEndOfTranslationUnit() override;
+
     json getJSON() { return _j; }
 
     static DeclarationMatcher GetMatcher() { return typeAliasDecl().bind("typealias"); }
@@ -47,6 +52,8 @@ public:
 private:
     processing_options _options;
     json _j;
+    // Matched, and extracted (see `ParallelExtract`) at the end of the translation unit.
+    std::vector<const TypeAliasDecl*> _decls;
 };
 
 /**************************************************************************************************/
@@ -21,6 +21,7 @@ written permission of Adobe.
 #include "clang/AST/ASTConsumer.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "_clang_include_suffix.hpp" // must be last to re-enable warnings
 // clang-format on
 
@@ -37,18 +38,37 @@ namespace hyde {
 
 /**************************************************************************************************/
 
-void TypedefInfo::run(const MatchFinder::MatchResult& Result) {
-    auto node = Result.Nodes.getNodeAs<TypedefDecl>("typedef");
-    auto info_opt = StandardDeclInfo(_options, node);
-    if (!info_opt) return;
+optional_json DetailTypedefDecl(const processing_options& options, const TypedefDecl* node) {
+    llvm::TimeTraceScope trace("MatchTypedef", [&] { return TraceDetail(node); });
+    auto info_opt = StandardDeclInfo(options, node);
+    if (!info_opt) return info_opt;
     auto info = std::move(*info_opt);
 
     // do not process class type aliases here.
-    if (!info["parents"].empty()) return;
+    if (!info["parents"].empty()) return std::nullopt;
 
     info["type"] = hyde::to_string(node, node->getUnderlyingType());
 
-    _j["typedefs"].push_back(std::move(info));
+    return info;
+}
+
+/**************************************************************************************************/
+
+void TypedefInfo::run(const MatchFinder::MatchResult& Result) {
+    _decls.push_back(Result.Nodes.getNodeAs<TypedefDecl>("typedef"));
+}
+
+/**************************************************************************************************/
+
+void TypedefInfo::onEndOfTranslationUnit() {
+    llvm::TimeTraceScope trace("ExtractTypedefs");
+    auto extracted = ParallelExtract(_options, _decls, &DetailTypedefDecl);
+
+    _decls.clear();
+
+    for (auto& info : extracted) {
+        if (info) _j["typedefs"].push_back(std::move(*info));
+    }
 }
 
 /**************************************************************************************************/
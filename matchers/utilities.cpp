@@ -13,9 +13,14 @@ written permission of Adobe.
 #include "utilities.hpp"
 
 // stdc++
+#include <array>
+#include <bit>
+#include <cstdint>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <vector>
 
 // clang/llvm
 // clang-format off
@@ -31,11 +36,7 @@ written permission of Adobe.
 #include "_clang_include_suffix.hpp" // must be last to re-enable warnings
 // clang-format on
 
-// diff
-#include "diff/myers.hpp"
-
 // application
-#include "emitters/yaml_base_emitter_fwd.hpp"
 #include "json.hpp"
 
 using namespace clang;
@@ -82,6 +83,7 @@ void chomp(std::string& src) {
 std::string to_string(const ASTContext* n, SourceRange range, bool as_token) {
     const auto char_range = as_token ? clang::CharSourceRange::getTokenRange(range) :
                                        clang::CharSourceRange::getCharRange(range);
+    std::lock_guard<std::recursive_mutex> lock(hyde::ASTMutex());
     // TODO: Make `result` a std::string_view
     std::string result =
         Lexer::getSourceText(char_range, n->getSourceManager(), n->getLangOpts()).str();
@@ -150,6 +152,22 @@ bool flag_set(const T& value, const T& flag) {
     return (static_cast<type>(value) & static_cast<type>(flag)) != 0;
 }
 
+/**************************************************************************************************/
+// Whether the name of `d` is printed from a type, as those of constructors, destructors, and
+// conversion functions are. Types may be printed with where they were declared, which takes the
+// source manager. (See `hyde::PrintType`.)
+bool name_prints_type(const NamedDecl* d) {
+    return isa<CXXConstructorDecl>(d) || isa<CXXDestructorDecl>(d) || isa<CXXConversionDecl>(d);
+}
+
+/**************************************************************************************************/
+
+std::string name_as_written(const FunctionDecl* function) {
+    if (!name_prints_type(function)) return function->getNameInfo().getAsString();
+    std::lock_guard<std::recursive_mutex> lock(hyde::ASTMutex());
+    return function->getNameInfo().getAsString();
+}
+
 /**************************************************************************************************/
 // See DeclPrinter::VisitFunctionDecl in clang/lib/AST/DeclPrinter.cpp for hints
 // on how to make this routine better.
@@ -225,7 +243,7 @@ std::string GetSignature(const ASTContext* n,
         signature << "operator "
                   << hyde::to_string(conversionDecl, conversionDecl->getConversionType());
     } else {
-        signature << hyde::PostProcessType(function, function->getNameInfo().getAsString());
+        signature << hyde::PostProcessType(function, name_as_written(function));
     }
 
     signature << "(";
@@ -291,7 +309,7 @@ std::string GetShortName(const clang::ASTContext* n, const clang::FunctionDecl*
     // the return type and the open paren. It's used e.g., for the file names
     // being output.
 
-    std::string result = hyde::PostProcessType(function, function->getNameInfo().getAsString());
+    std::string result = hyde::PostProcessType(function, name_as_written(function));
 
     if (!isa<CXXConstructorDecl>(function) && !isa<CXXDestructorDecl>(function) &&
         !isa<CXXConversionDecl>(function)) {
@@ -620,6 +638,102 @@ hyde::optional_json group_comments_by_kind(hyde::json comments) {
 
 /**************************************************************************************************/
 
+// The length of the longest common subsequence of `a` and `b`, computed with the bit-parallel
+// algorithm of Allison & Dix (as formulated by Hyyrö): each bit of `v` is a column of the DP matrix
+// for `b`, and a whole row of it is advanced with a handful of word operations per character of `a`.
+// The match masks live in thread-local storage and are cleared after use, so once warm this
+// allocates nothing.
+//
+// Every row of `a` left to go can lengthen the subsequence by at most one, so when `floor` is
+// given, the rows stop as soon as the subsequence so far plus the rows left falls short of it; the
+// result is then some length under `floor` rather than the exact one.
+std::size_t lcs_length(std::string_view a, std::string_view b, std::size_t floor = 0) {
+    constexpr std::size_t word_bits_k = 64;
+    // How many rows go by between checks against `floor`, to keep the popcounts off the hot path.
+    constexpr std::size_t check_rows_k = 16;
+    const auto index = [](char c) { return static_cast<unsigned char>(c); };
+
+    if (b.size() <= word_bits_k) {
+        thread_local std::array<std::uint64_t, 256> masks{};
+
+        for (std::size_t j = 0; j < b.size(); ++j) {
+            masks[index(b[j])] |= std::uint64_t{1} << j;
+        }
+
+        const std::uint64_t columns =
+            b.size() == word_bits_k ? ~std::uint64_t{0} : (std::uint64_t{1} << b.size()) - 1;
+        std::uint64_t v = ~std::uint64_t{0};
+
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            const std::uint64_t u = v & masks[index(a[i])];
+            v = (v + u) | (v - u);
+
+            if (floor && (i + 1) % check_rows_k == 0 &&
+                std::popcount(~v & columns) + (a.size() - i - 1) < floor) {
+                break;
+            }
+        }
+
+        for (const auto& c : b) {
+            masks[index(c)] = 0;
+        }
+
+        return std::popcount(~v & columns);
+    }
+
+    // Longer strings span several words, with the carry of the addition rippling from one word to
+    // the next. (The subtraction above never borrows, as `u` is a subset of `v`, so it becomes a
+    // mask here.)
+    const std::size_t words = (b.size() + word_bits_k - 1) / word_bits_k;
+    thread_local std::vector<std::uint64_t> masks;
+    thread_local std::vector<std::uint64_t> v;
+
+    if (masks.size() < 256 * words) masks.resize(256 * words, 0);
+    v.assign(words, ~std::uint64_t{0});
+
+    for (std::size_t j = 0; j < b.size(); ++j) {
+        masks[index(b[j]) * words + j / word_bits_k] |= std::uint64_t{1} << (j % word_bits_k);
+    }
+
+    const std::size_t tail = b.size() - (words - 1) * word_bits_k;
+    const std::uint64_t columns =
+        tail == word_bits_k ? ~std::uint64_t{0} : (std::uint64_t{1} << tail) - 1;
+    const auto length = [&] {
+        std::size_t result = 0;
+
+        for (std::size_t w = 0; w + 1 < words; ++w) {
+            result += std::popcount(~v[w]);
+        }
+
+        return result + std::popcount(~v[words - 1] & columns);
+    };
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        const std::uint64_t* mask = &masks[index(a[i]) * words];
+        std::uint64_t carry = 0;
+
+        for (std::size_t w = 0; w < words; ++w) {
+            const std::uint64_t u = v[w] & mask[w];
+            const std::uint64_t partial = v[w] + u;
+            const std::uint64_t sum = partial + carry;
+            carry = (partial < u) | (sum < partial);
+            v[w] = sum | (v[w] & ~mask[w]);
+        }
+
+        if (floor && (i + 1) % check_rows_k == 0 && length() + (a.size() - i - 1) < floor) {
+            break;
+        }
+    }
+
+    for (const auto& c : b) {
+        std::fill_n(&masks[index(c) * words], words, 0);
+    }
+
+    return length();
+}
+
+/**************************************************************************************************/
+
 } // namespace
 
 /**************************************************************************************************/
@@ -649,11 +763,11 @@ optional_json DetailCXXRecordDecl(const hyde::processing_options& options,
     // overrides for various fields if the record is of a specific sub-type.
     if (auto s = llvm::dyn_cast_or_null<ClassTemplateSpecializationDecl>(cxx)) {
         info["name"] = hyde::to_string(s, s->getTypeAsWritten()->getType());
-        info["qualified_name"] = s->getQualifiedNameAsString();
+        info["qualified_name"] = QualifiedName(s);
     } else if (auto template_decl = cxx->getDescribedClassTemplate()) {
         std::string arguments = GetArgumentList(template_decl->getTemplateParameters()->asArray());
         info["name"] = static_cast<const std::string&>(info["name"]) + arguments;
-        info["qualified_name"] = template_decl->getQualifiedNameAsString();
+        info["qualified_name"] = QualifiedName(template_decl);
     }
 
     return info;
@@ -727,7 +841,12 @@ optional_json DetailFunctionDecl(const hyde::processing_options& options, const
             break;
     }
 
-    auto visibility = f->getVisibility();
+    // Linkage is computed (and cached) as it is asked for.
+    std::unique_lock<std::recursive_mutex> linkage_lock(ASTMutex());
+    const auto visibility = f->getVisibility();
+    const LinkageInfo linkage_info = f->getLinkageAndVisibility();
+    linkage_lock.unlock();
+
     switch (visibility) {
         case Visibility::HiddenVisibility:
             info["visibility"] = "hidden";
@@ -739,7 +858,6 @@ optional_json DetailFunctionDecl(const hyde::processing_options& options, const
             info["visibility"] = "protected";
             break;
     }
-    LinkageInfo linkage_info = f->getLinkageAndVisibility();
     info["visibility_explicit"] = linkage_info.isVisibilityExplicit() ? "true" : "false";
 
     if (const auto* method = llvm::dyn_cast_or_null<CXXMethodDecl>(f)) {
@@ -808,7 +926,9 @@ std::string GetArgumentList(const llvm::ArrayRef<clang::NamedDecl*> args) {
 
 bool PathCheck(const std::vector<std::string>& paths, const Decl* d, ASTContext* n) {
     auto beginLoc = d->getBeginLoc();
+    std::unique_lock<std::recursive_mutex> lock(ASTMutex());
     auto location = beginLoc.printToString(n->getSourceManager());
+    lock.unlock();
     std::string path = location.substr(0, location.find(':'));
     return std::find(paths.begin(), paths.end(), path) != paths.end();
 }
@@ -878,8 +998,10 @@ std::string PostProcessTypeParameter(const clang::Decl* decl, std::string type)
             if (auto* template_type = dyn_cast<TemplateTypeParmDecl>(parameter_decl)) {
                 auto depth = template_type->getDepth();
                 auto index = template_type->getIndex();
+                std::unique_lock<std::recursive_mutex> lock(ASTMutex()); // creates the type
                 auto qualType = context.getTemplateTypeParmType(
                     depth, index, template_type->isParameterPack(), template_type);
+                lock.unlock();
 
                 std::string old_type = needle + std::to_string(depth) + "-" + std::to_string(index);
                 std::string new_type = hyde::to_string(template_type, qualType);
@@ -899,6 +1021,19 @@ std::string PostProcessTypeParameter(const clang::Decl* decl, std::string type)
         }
     });
 
+    return ResolveTypeParameters(std::move(type), parent_template_types);
+}
+
+/**************************************************************************************************/
+
+std::string ResolveTypeParameters(std::string type,
+                                  const std::vector<std::pair<std::string, std::string>>& parameters) {
+    static const std::string needle("type-parameter-");
+
+    auto pos = type.find(needle);
+
+    if (pos == std::string::npos) return type;
+
     while (true) {
         auto end_pos = pos + needle.size();
 
@@ -912,12 +1047,12 @@ std::string PostProcessTypeParameter(const clang::Decl* decl, std::string type)
         auto length = end_pos - pos;
         std::string old_type = type.substr(pos, length);
 
-        // sort and lower_bound this? parent_template_types.size() is usually
+        // sort and lower_bound this? parameters.size() is usually
         // small (< 5 or so), so it might not be worth the effort.
-        auto found = std::find_if(parent_template_types.begin(), parent_template_types.end(),
+        auto found = std::find_if(parameters.begin(), parameters.end(),
                                   [&](const auto& cur_pair) { return cur_pair.first == old_type; });
 
-        if (found != parent_template_types.end()) {
+        if (found != parameters.end()) {
             const auto& new_type = found->second;
             type.replace(pos, length, new_type);
             pos += new_type.size();
@@ -959,12 +1094,48 @@ std::string PostProcessType(const clang::Decl* decl, std::string type) {
 
 /**************************************************************************************************/
 
-hyde::optional_json ProcessComments(const Decl* d) {
+hyde::optional_json ProcessComments(const hyde::processing_options& options, const Decl* d) {
     const ASTContext& n = d->getASTContext();
-    const FullComment* full_comment = n.getCommentForDecl(d, nullptr);
+    const FullComment* full_comment{nullptr};
+
+    {
+        // Comments are attached to declarations, parsed, and cached as they are asked for. What
+        // is read from them afterwards is read only.
+        std::lock_guard<std::recursive_mutex> lock(ASTMutex());
+        full_comment = n.getCommentForDecl(d, nullptr);
+        if (full_comment) full_comment->getDeclInfo();
+    }
 
     if (!full_comment) return std::nullopt;
 
+    if (options._emitted_comments_only) {
+        hyde::json::array_t children;
+
+        auto first = full_comment->child_begin();
+        auto last = full_comment->child_end();
+
+        for (; first != last; ++first) {
+            const Comment* child = *first;
+
+            switch (child->getCommentKind()) {
+                case CommentKind::BlockCommandComment:
+                case CommentKind::ParagraphComment:
+                case CommentKind::ParamCommandComment:
+                    break;
+                default:
+                    continue; // e.g., `\code` blocks, which can be the bulk of a comment
+            }
+
+            if (auto entry = ProcessComment(n, full_comment, child)) {
+                children.emplace_back(std::move(*entry));
+            }
+        }
+
+        if (children.empty()) return std::nullopt;
+
+        return group_comments_by_kind(std::move(children));
+    }
+
     if (auto result = ProcessComment(n, full_comment, full_comment)) {
         // The top-level FullComment has only been observed to have
         // children and nothing else. Roll up the children as the
@@ -977,100 +1148,107 @@ hyde::optional_json ProcessComments(const Decl* d) {
 
 /**************************************************************************************************/
 
-constexpr auto hyde_version_major_k = 2;
-constexpr auto hyde_version_minor_k = 1;
-constexpr auto hyde_version_patch_k = 0;
-
-const std::string& hyde_version() {
-    static const std::string result = std::to_string(hyde_version_major_k) +
-                                      "." + std::to_string(hyde_version_minor_k) +
-                                      "." + std::to_string(hyde_version_patch_k);
-    return result;
+std::string TraceDetail(const NamedDecl* d) {
+    std::lock_guard<std::recursive_mutex> lock(ASTMutex());
+    return d->getQualifiedNameAsString() + " (" +
+           d->getLocation().printToString(d->getASTContext().getSourceManager()) + ")";
 }
 
 /**************************************************************************************************/
 
-std::filesystem::path derive_transcription_src_path(const std::filesystem::path& dst,
-                                                    const std::string& title) {
-    // std::cout << "deriving transcription src for \"" << title << "\", dst: " << dst.string() << '\n';
+std::string PrintType(const Decl* decl, QualType type) {
+    // Not static: translation units (in one process) need not share language options.
+    PrintingPolicy policy(decl->getASTContext().getLangOpts());
 
-    const auto parent = dst.parent_path();
-    std::size_t best_match = std::numeric_limits<std::size_t>::max();
-    std::filesystem::path result;
-    const std::string& current_version = hyde_version();
+    // Unnamed types are printed with where they were declared, which takes the source manager.
+    // Try without it first, and print again with it in the (rare) case it is needed.
+    policy.AnonymousTagLocations = false;
+    std::string result = type.getAsString(policy);
 
-    for (const auto& entry : std::filesystem::directory_iterator(dst.parent_path())) {
-        const auto sibling = entry.path();
-        if (!is_directory(sibling)) continue;
-        const auto index_path = sibling / index_filename_k;
+    if (result.find("(lambda") == std::string::npos &&
+        result.find("(anonymous") == std::string::npos &&
+        result.find("(unnamed") == std::string::npos) {
+        return result;
+    }
 
-        if (!exists(index_path)) {
-            std::cerr << "WARN: expected " << index_path.string() << " but did not find one\n";
-            continue;
-        }
+    policy.AnonymousTagLocations = true;
+    std::lock_guard<std::recursive_mutex> lock(ASTMutex());
+    return type.getAsString(policy);
+}
 
-        const auto have_docs = parse_documentation(index_path, true);
+/**************************************************************************************************/
 
-        if (have_docs._error) {
-            std::cerr << "WARN: expected " << index_path.string() << " to have docs\n";
-            continue;
-        }
+std::string Name(const NamedDecl* d) {
+    if (!name_prints_type(d)) return d->getNameAsString();
+    std::lock_guard<std::recursive_mutex> lock(ASTMutex());
+    return d->getNameAsString();
+}
 
-        const auto& have = have_docs._json;
-
-        if (have.count("hyde")) {
-            const auto& have_hyde = have.at("hyde");
-            if (have_hyde.count("version")) {
-                // Transcription is when we're going from a previous version of hyde to this one.
-                // So if the versions match, this is a directory that has already been transcribed.
-                // (Transcribing from a newer version of hyde docs to older ones isn't supported.)
-                if (static_cast<const std::string&>(have_hyde.at("version")) == current_version) {
-                    // std::cout << "    candidate (VSKIP) src: " << sibling.string() << '\n';
-                    continue;
-                }
-            }
-        }
+/**************************************************************************************************/
 
-        // REVISIT (fosterbrereton): Are these titles editable? Would
-        // users muck with them and thus break this algorithm?
-        const std::string& have_title = static_cast<const std::string&>(have["title"]);
+std::string QualifiedName(const NamedDecl* d) {
+    // The names of enclosing functions and template specializations are printed with the types of
+    // their parameters and arguments. (See `PrintType`.)
+    for (const DeclContext* context = d->getDeclContext(); context;
+         context = context->getParent()) {
+        if (isa<FunctionDecl>(context) || isa<ClassTemplateSpecializationDecl>(context)) {
+            std::lock_guard<std::recursive_mutex> lock(ASTMutex());
+            return d->getQualifiedNameAsString();
+        }
+    }
 
-        // score going from what we have to what this version computed.
-        const auto match = diff_score(have_title, title);
+    return d->getQualifiedNameAsString();
+}
 
-        // std::cout << "    candidate (" << match << "): \"" << have_title << "\", src: " << sibling.string() << '\n';
+/**************************************************************************************************/
 
-        if (match > best_match) {
-            continue;
-        }
+std::recursive_mutex& ASTMutex() {
+    static std::recursive_mutex result;
+    return result;
+}
 
-        best_match = match;
-        result = sibling;
-    }
+/**************************************************************************************************/
 
-    // std::cout << "    result is: " << result.string() << " (" << best_match << ")\n";
+constexpr auto hyde_version_major_k = 2;
+constexpr auto hyde_version_minor_k = 1;
+constexpr auto hyde_version_patch_k = 0;
 
+const std::string& hyde_version() {
+    static const std::string result = std::to_string(hyde_version_major_k) +
+                                      "." + std::to_string(hyde_version_minor_k) +
+                                      "." + std::to_string(hyde_version_patch_k);
     return result;
 }
 
 /**************************************************************************************************/
 
 std::size_t diff_score(std::string_view src, std::string_view dst) {
-    const myers::patch patch = myers::diff(src, dst);
-    std::size_t score = 0;
+    // The score is the insert/delete edit distance between the two strings: every character not
+    // part of their longest common subsequence has to be either deleted or inserted. The
+    // subsequence is found column-wise over the shorter string, which keeps it in as few words as
+    // possible.
+    const std::size_t lcs =
+        src.size() < dst.size() ? lcs_length(dst, src) : lcs_length(src, dst);
+
+    return src.size() + dst.size() - 2 * lcs;
+}
 
-    for (const auto& c : patch) {
-        switch (c.operation) {
-            case myers::operation::cpy:
-                break;
-            case myers::operation::del:
-            case myers::operation::ins: {
-                score += c.text.size();
-            } break;
-        }
+/**************************************************************************************************/
+
+std::size_t diff_score(std::string_view src, std::string_view dst, std::size_t bound) {
+    // The difference in length alone has to be inserted or deleted.
+    if ((src.size() > dst.size() ? src.size() - dst.size() : dst.size() - src.size()) > bound) {
+        return bound + 1;
     }
 
-    return score;
+    // A score within `bound` needs a common subsequence at least this long, so the rows can stop
+    // once it is out of reach.
+    const std::size_t total = src.size() + dst.size();
+    const std::size_t floor = total > bound ? (total - bound + 1) / 2 : 0;
+    const std::size_t lcs =
+        src.size() < dst.size() ? lcs_length(dst, src, floor) : lcs_length(src, dst, floor);
+
+    return std::min(total - 2 * lcs, bound + 1);
 }
 
 /**************************************************************************************************/
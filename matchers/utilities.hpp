@@ -12,11 +12,18 @@ written permission of Adobe.
 #pragma once
 
 // stdc++
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 // clang/llvm
 // clang-format off
 #include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "clang/AST/ASTContext.h"
 #include "clang/AST/Attr.h"
 #include "clang/AST/Decl.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
@@ -60,8 +67,145 @@ std::string ReplaceAll(std::string str, const std::string& substr, const std::st
 // type-parameter-N-M filtering.
 std::string PostProcessType(const clang::Decl* decl, std::string type);
 
-// Doxygen-style comments.
-optional_json ProcessComments(const clang::Decl* d);
+// Replaces every `type-parameter-N-M` in `type` found in `parameters`, a list of
+// (`type-parameter-N-M`, replacement) pairs. Those not found are left as they are.
+std::string ResolveTypeParameters(std::string type,
+                                  const std::vector<std::pair<std::string, std::string>>& parameters);
+
+// Collapses the `> >` of nested template arguments to `>>`.
+std::string PostProcessSpacing(std::string type);
+
+// Doxygen-style comments. With `options._emitted_comments_only`, only the paragraphs, block
+// commands, and parameters (those `yaml_base_emitter::insert_doxygen` reads) are converted.
+optional_json ProcessComments(const processing_options& options, const clang::Decl* d);
+
+// The qualified name and location of a declaration, to identify it in time trace events.
+std::string TraceDetail(const clang::NamedDecl* d);
+
+// `type` as written by clang. See `to_string`.
+std::string PrintType(const clang::Decl* decl, clang::QualType type);
+
+// `d->getNameAsString()` and `d->getQualifiedNameAsString()`, made safe to call from any thread.
+std::string Name(const clang::NamedDecl* d);
+std::string QualifiedName(const clang::NamedDecl* d);
+
+/**************************************************************************************************/
+
+// Held while using the parts of an AST that are not safe to use from more than one thread at a
+// time: the source manager (whose lookups update caches of their own), the attachment and parsing
+// of comments, the computation of linkage, and anything that creates types or builds lookup
+// tables. The rest of what the matchers extract from a declaration only reads the AST.
+std::recursive_mutex& ASTMutex();
+
+// How many declarations an extraction thread takes at a time.
+constexpr std::size_t extraction_chunk_k = 16;
+
+/// Calls `extract(options, d)` for each `d` of `decls`, across `options._extraction_threads`
+/// threads, taking them in chunks as each thread is ready for more.
+/// @return What each call returned, in the order of `decls`.
+/// Each thread counts what it rejects apart from the others, and the counts are added to
+/// `options._rejections` once all are done. The first exception thrown by `extract`, if any, is
+/// rethrown then, too.
+template <typename DeclarationType, typename F>
+std::vector<optional_json> ParallelExtract(const processing_options& options,
+                                           const std::vector<const DeclarationType*>& decls,
+                                           F extract) {
+    std::vector<optional_json> result(decls.size());
+
+    if (decls.empty()) return result;
+
+    // An AST backed by an external source (a PCH or modules) loads declarations as they are
+    // first used, so it is only extracted by the one thread.
+    clang::ASTContext& context = decls.front()->getASTContext();
+    const std::size_t threads = context.getExternalSource() ?
+                                    1 :
+                                    std::clamp<std::size_t>(options._extraction_threads, 1,
+                                                            decls.size());
+
+    if (threads == 1) {
+        for (std::size_t i = 0; i < decls.size(); ++i) {
+            result[i] = extract(options, decls[i]);
+        }
+        return result;
+    }
+
+    // The map of parents is built on first use. Build it before there is anyone to race with.
+    context.getParents(*decls.front());
+
+    std::vector<rejection_counts> rejections(threads);
+    std::vector<std::exception_ptr> errors(threads);
+    std::atomic<std::size_t> next{0};
+
+    const auto work = [&](std::size_t index) {
+        processing_options local = options;
+        if (options._rejections) local._rejections = &rejections[index];
+
+        try {
+            while (true) {
+                const std::size_t first = next.fetch_add(extraction_chunk_k);
+                if (first >= decls.size()) break;
+                const std::size_t last = std::min(first + extraction_chunk_k, decls.size());
+                for (std::size_t i = first; i < last; ++i) {
+                    result[i] = extract(local, decls[i]);
+                }
+            }
+        } catch (...) {
+            errors[index] = std::current_exception();
+            next = decls.size(); // stop the others, too
+        }
+    };
+
+    std::vector<std::thread> workers;
+
+    for (std::size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(work, i);
+    }
+
+    work(0);
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    if (options._rejections) {
+        for (const auto& counts : rejections) {
+            options._rejections->_path += counts._path;
+            options._rejections->_access += counts._access;
+            options._rejections->_namespace += counts._namespace;
+        }
+    }
+
+    for (const auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+/// Extracts `decls` as `ParallelExtract` does, and hands each symbol extracted, in order, to
+/// `consume`. With a sink (see `processing_options::_sink`) the symbols are wanted one at a time,
+/// so the declarations are extracted a few chunks at a time, and only those are held at once.
+template <typename DeclarationType, typename F, typename C>
+void ExtractEach(const processing_options& options,
+                 const std::vector<const DeclarationType*>& decls,
+                 F extract,
+                 C consume) {
+    // A few chunks for each thread, so they still take them as they are ready.
+    const std::size_t threads = std::max<std::size_t>(options._extraction_threads, 1);
+    const std::size_t window = options._sink ? threads * extraction_chunk_k * 4 : decls.size();
+
+    for (std::size_t first = 0; first < decls.size(); first += window) {
+        const std::size_t last = std::min(first + window, decls.size());
+        const std::vector<const DeclarationType*> some(decls.begin() + first,
+                                                       decls.begin() + last);
+
+        for (auto& symbol : ParallelExtract(options, some, extract)) {
+            if (symbol) consume(std::move(*symbol));
+        }
+    }
+}
 
 /**************************************************************************************************/
 
@@ -73,10 +217,10 @@ const std::string& hyde_version();
 /// each other. The lower the value the better, with 0 meaning the two strings are identical.
 std::size_t diff_score(std::string_view src, std::string_view dst);
 
-// Iterate the list of `dst` subfolders, find their `index.md` files, load the `title` of each, and
-// find the best-fit against the given `title`. This facilitates the transcription behavior.
-std::filesystem::path derive_transcription_src_path(const std::filesystem::path& dst,
-                                                    const std::string& title);
+/// As above, but any score exceeding `bound` is reported as `bound + 1`, and pairs whose lengths
+/// alone differ by more than `bound` are not scored at all. Use this when only scores under some
+/// threshold are of interest.
+std::size_t diff_score(std::string_view src, std::string_view dst, std::size_t bound);
 
 /**************************************************************************************************/
 
@@ -97,8 +241,7 @@ inline std::string to_string(clang::AccessSpecifier access) {
 /**************************************************************************************************/
 
 inline std::string to_string(const clang::Decl* decl, clang::QualType type) {
-    static const clang::PrintingPolicy policy(decl->getASTContext().getLangOpts());
-    std::string result = PostProcessType(decl, type.getAsString(policy));
+    std::string result = PostProcessType(decl, PrintType(decl, type));
     bool is_lambda = result.find("(lambda at ") == 0;
     return is_lambda ? "__lambda" : result;
 }
@@ -109,28 +252,38 @@ template <typename DeclarationType>
 optional_json StandardDeclInfo(const hyde::processing_options& options, const DeclarationType* d) {
     clang::ASTContext* n = &d->getASTContext();
 
-    if (!PathCheck(options._paths, d, n)) return std::nullopt;
+    if (!PathCheck(options._paths, d, n)) {
+        if (options._rejections) ++options._rejections->_path;
+        return std::nullopt;
+    }
 
     json info = json::object();
 
-    info["name"] = d->getNameAsString();
+    info["name"] = Name(d);
     info["namespaces"] = GetParentNamespaces(n, d);
     info["parents"] = GetParentCXXRecords(n, d);
-    info["qualified_name"] = d->getQualifiedNameAsString();
+    info["qualified_name"] = QualifiedName(d);
 
-    if (NamespaceBlacklist(options._namespace_blacklist, info)) return std::nullopt;
+    if (NamespaceBlacklist(options._namespace_blacklist, info)) {
+        if (options._rejections) ++options._rejections->_namespace;
+        return std::nullopt;
+    }
 
     auto clang_access = d->getAccess();
 
-    if (!AccessCheck(options._access_filter, clang_access)) return std::nullopt;
+    if (!AccessCheck(options._access_filter, clang_access)) {
+        if (options._rejections) ++options._rejections->_access;
+        return std::nullopt;
+    }
 
-    if (auto comments = ProcessComments(d)) {
+    if (auto comments = ProcessComments(options, d)) {
         info["comments"] = std::move(*comments);
     }
 
     if (clang_access != clang::AccessSpecifier::AS_none) info["access"] = to_string(clang_access);
 
     info["defined_in_file"] = [&] {
+        std::lock_guard<std::recursive_mutex> lock(ASTMutex());
         auto beginLoc = d->getBeginLoc();
         auto location = beginLoc.printToString(n->getSourceManager());
         return location.substr(0, location.find(':'));
@@ -15,15 +15,40 @@ written permission of Adobe.
 // stdc++
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <iterator>
 #include <memory>
+#include <optional>
 #include <random>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+// clang/llvm
+// clang-format off
+#include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/Version.h"
+#include "clang/Driver/Compilation.h"
+#include "clang/Driver/Driver.h"
+#include "clang/Driver/ToolChain.h"
+#include "llvm/Option/ArgList.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/TargetParser/Host.h"
+#include "_clang_include_suffix.hpp" // must be last to re-enable warnings
+// clang-format on
+
+// application
+#include "json.hpp"
+#include "emitters/yaml_base_emitter.hpp"
+
 /**************************************************************************************************/
 
 namespace {
@@ -155,6 +180,296 @@ std::vector<std::filesystem::path> autodetect_include_paths() {
 
 /**************************************************************************************************/
 
+struct toolchain_paths {
+    std::vector<std::filesystem::path> _includes;
+    std::filesystem::path _resource_dir;
+    std::filesystem::path _gcc_installation; // the GCC the driver took its C++ library from, if any
+};
+
+/**************************************************************************************************/
+
+// The GCC installation the toolchain selected, as the driver reports it for `clang++ -v`. Empty if
+// the toolchain does not use one.
+std::filesystem::path selected_gcc_installation(const clang::driver::ToolChain& toolchain) {
+    static const std::string_view prefix_k{"Selected GCC installation: "};
+    std::string info;
+    llvm::raw_string_ostream stream(info);
+
+    toolchain.printVerboseInfo(stream);
+    stream.flush();
+
+    const auto found = info.find(prefix_k);
+
+    if (found == std::string::npos) return std::filesystem::path();
+
+    const auto begin = found + prefix_k.size();
+
+    return std::filesystem::path(info.substr(begin, info.find('\n', begin) - begin));
+}
+
+// Ask the clang driver linked into hyde for the include search list and resource directory the
+// system's clang++ would use, which is much cheaper than running clang++ to find out. This is only
+// possible when the resource directory of the installed clang++ is laid out for the same version of
+// clang as hyde's; otherwise the result is empty, and clang++ has to be asked after all.
+std::optional<toolchain_paths> driver_toolchain_paths(const std::filesystem::path& clangxx) {
+    clang::DiagnosticsEngine diagnostics(new clang::DiagnosticIDs(), new clang::DiagnosticOptions(),
+                                         new clang::IgnoringDiagConsumer());
+    clang::driver::Driver driver(clangxx.string(), llvm::sys::getDefaultTargetTriple(), diagnostics);
+
+    driver.setCheckInputsExist(false);
+
+    const std::array<const char*, 5> arguments{"clang++", "-x", "c++", "-fsyntax-only", "hyde.cpp"};
+    std::unique_ptr<clang::driver::Compilation> compilation(driver.BuildCompilation(arguments));
+
+    if (!compilation || diagnostics.hasErrorOccurred() ||
+        !std::filesystem::exists(driver.ResourceDir)) {
+        return std::nullopt;
+    }
+
+    const clang::driver::ToolChain& toolchain = compilation->getDefaultToolChain();
+    llvm::opt::ArgStringList cc1_arguments;
+
+    toolchain.AddClangCXXStdlibIncludeArgs(compilation->getArgs(), cc1_arguments);
+    toolchain.AddClangSystemIncludeArgs(compilation->getArgs(), cc1_arguments);
+
+    toolchain_paths result;
+
+    result._resource_dir = driver.ResourceDir;
+    result._gcc_installation = selected_gcc_installation(toolchain);
+
+    // Each include directory follows the flag saying what kind it is. Like `clang++ -v`, ignore
+    // duplicates and directories that do not exist.
+    for (std::size_t i = 0; i + 1 < cc1_arguments.size(); ++i) {
+        const std::string_view flag(cc1_arguments[i]);
+
+        if (flag != "-internal-isystem" && flag != "-internal-externc-isystem" &&
+            flag != "-internal-iframework" && flag != "-isystem" && flag != "-iframework") {
+            continue;
+        }
+
+        std::filesystem::path directory(cc1_arguments[++i]);
+
+        if (!std::filesystem::exists(directory) ||
+            std::find(begin(result._includes), end(result._includes), directory) !=
+                end(result._includes)) {
+            continue;
+        }
+
+        result._includes.push_back(std::move(directory));
+    }
+
+    if (result._includes.empty()) return std::nullopt;
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+// Identifies the clang++ the toolchain paths were detected for. The paths change when the compiler
+// does, so they can be kept across runs of hyde; they also change when the GCC installation the
+// compiler takes its C++ library from does, which is checked when a cached entry is read.
+struct toolchain_key {
+    std::filesystem::path _clangxx; // resolved, so a symlink pointing elsewhere is a new key
+    std::int64_t _mtime{0};
+    std::uintmax_t _size{0};
+};
+
+std::optional<toolchain_key> derive_toolchain_key() {
+    const auto clangxx = llvm::sys::findProgramByName("clang++");
+
+    if (!clangxx) return std::nullopt;
+
+    std::error_code error;
+    toolchain_key result;
+
+    result._clangxx = std::filesystem::canonical(*clangxx, error);
+    if (error) return std::nullopt;
+    result._mtime = std::filesystem::last_write_time(result._clangxx, error).time_since_epoch().count();
+    if (error) return std::nullopt;
+    result._size = std::filesystem::file_size(result._clangxx, error);
+    if (error) return std::nullopt;
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+std::optional<std::filesystem::path> autodetect_cache_path() {
+    if (const char* cache_home = std::getenv("XDG_CACHE_HOME"); cache_home && *cache_home) {
+        return std::filesystem::path(cache_home) / "hyde" / "autodetect.json";
+    }
+
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return std::filesystem::path(home) / ".cache" / "hyde" / "autodetect.json";
+    }
+
+    return std::nullopt;
+}
+
+/**************************************************************************************************/
+
+hyde::json read_autodetect_cache(const std::filesystem::path& path) {
+    std::ifstream input(path);
+
+    if (!input) return hyde::json::object();
+
+    hyde::json result = hyde::json::parse(input, nullptr, false);
+
+    return result.is_object() ? result : hyde::json::object();
+}
+
+/**************************************************************************************************/
+
+// Whether detection found everything it looks for.
+bool complete(const toolchain_paths& paths) {
+    std::error_code error;
+    return !paths._includes.empty() && !paths._resource_dir.empty() &&
+           std::filesystem::is_directory(paths._resource_dir, error);
+}
+
+/**************************************************************************************************/
+
+// The modification time of the directory holding the given GCC installation and any others of its
+// kind (e.g., `/usr/lib/gcc/x86_64-linux-gnu`), or zero if there is none.
+std::int64_t gcc_installations_mtime(const std::filesystem::path& gcc_installation) {
+    if (gcc_installation.empty()) return 0;
+
+    std::error_code error;
+    const auto result = std::filesystem::last_write_time(gcc_installation.parent_path(), error);
+
+    return error ? 0 : result.time_since_epoch().count();
+}
+
+/**************************************************************************************************/
+
+// The version of clang++ is recorded along with its paths to make the cache legible; it is not part
+// of the lookup, which would mean running clang++ every time. The version of the driver built into
+// hyde is, though, since that is what computes the paths in the first place.
+//
+// A GCC installed or removed alongside the one selected changes which one clang++ would select, and
+// the directory they sit in with it, so the modification time of that directory is recorded, too.
+// Anything the entry names that is no longer there also makes it stale.
+std::optional<toolchain_paths> find_cached_toolchain(const hyde::json& cache,
+                                                     const toolchain_key& key) {
+    const auto found = cache.find(key._clangxx.string());
+
+    if (found == cache.end() || !found->is_object()) return std::nullopt;
+
+    const auto& entry = *found;
+
+    if (entry.value("mtime", std::int64_t{0}) != key._mtime ||
+        entry.value("size", std::uintmax_t{0}) != key._size ||
+        entry.value("driver", std::string()) != clang::getClangFullVersion() ||
+        !entry.count("includes") || !entry.at("includes").is_array() ||
+        !entry.count("resource_dir") || !entry.at("resource_dir").is_string() ||
+        !entry.count("gcc_installation") || !entry.at("gcc_installation").is_string()) {
+        return std::nullopt;
+    }
+
+    toolchain_paths result;
+    std::error_code error;
+
+    for (const auto& include : entry.at("includes")) {
+        if (!include.is_string()) return std::nullopt;
+        result._includes.emplace_back(include.get<std::string>());
+        if (!std::filesystem::is_directory(result._includes.back(), error)) return std::nullopt;
+    }
+
+    result._resource_dir = entry.at("resource_dir").get<std::string>();
+    result._gcc_installation = entry.at("gcc_installation").get<std::string>();
+
+    if (!complete(result)) return std::nullopt;
+
+    if (!result._gcc_installation.empty() &&
+        (!std::filesystem::is_directory(result._gcc_installation, error) ||
+         entry.value("gcc_installations_mtime", std::int64_t{0}) !=
+             gcc_installations_mtime(result._gcc_installation))) {
+        return std::nullopt;
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+void store_cached_toolchain(const std::filesystem::path& path,
+                            const toolchain_key& key,
+                            const toolchain_paths& paths) {
+    // Another hyde may have updated the cache since it was read; merge into its latest contents.
+    hyde::json cache = read_autodetect_cache(path);
+    hyde::json includes = hyde::json::array();
+
+    for (const auto& include : paths._includes) {
+        includes.push_back(include.string());
+    }
+
+    const std::string version = exec(("\"" + key._clangxx.string() + "\" --version").c_str());
+
+    cache[key._clangxx.string()] = hyde::json::object({
+        {"mtime", key._mtime},
+        {"size", key._size},
+        {"version", version.substr(0, version.find('\n'))},
+        {"driver", clang::getClangFullVersion()},
+        {"includes", std::move(includes)},
+        {"resource_dir", paths._resource_dir.string()},
+        {"gcc_installation", paths._gcc_installation.string()},
+        {"gcc_installations_mtime", gcc_installations_mtime(paths._gcc_installation)},
+    });
+
+    // Many instances of hyde may be racing to do this; none of them may read a partially-written
+    // cache. Failures are harmless, if slower.
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    if (error) return;
+
+    hyde::write_file_atomic(path, cache.dump(2) + '\n');
+}
+
+/**************************************************************************************************/
+
+toolchain_paths detect_toolchain(const std::optional<toolchain_key>& key) {
+    if (key) {
+        if (auto result = driver_toolchain_paths(key->_clangxx)) {
+            return std::move(*result);
+        }
+    }
+
+    return toolchain_paths{autodetect_include_paths(),
+                           std::filesystem::path{exec("clang++ -print-resource-dir")}};
+}
+
+/**************************************************************************************************/
+
+const toolchain_paths& autodetected_toolchain() {
+    static const toolchain_paths result = [] {
+        llvm::TimeTraceScope trace("AutodetectToolchain");
+        const auto key = derive_toolchain_key();
+        const auto cache_path = autodetect_cache_path();
+
+        if (!key || !cache_path) return detect_toolchain(key);
+
+        if (auto cached = find_cached_toolchain(read_autodetect_cache(*cache_path), *key)) {
+            return std::move(*cached);
+        }
+
+        auto detected = [&] {
+            llvm::TimeTraceScope detect_trace("DetectToolchain", [&] {
+                return key->_clangxx.string();
+            });
+            return detect_toolchain(key);
+        }();
+
+        // A failed probe of clang++ would otherwise be the answer until clang++ itself changed.
+        if (complete(detected)) store_cached_toolchain(*cache_path, *key, detected);
+
+        return detected;
+    }();
+
+    return result;
+}
+
+/**************************************************************************************************/
+
 } // namespace
 
 /**************************************************************************************************/
@@ -164,18 +479,19 @@ namespace hyde {
 /**************************************************************************************************/
 
 std::vector<std::filesystem::path> autodetect_toolchain_paths() {
-    return autodetect_include_paths();
+    return autodetected_toolchain()._includes;
 }
 
 /**************************************************************************************************/
 
 std::filesystem::path autodetect_resource_directory() {
-    return std::filesystem::path{exec("clang++ -print-resource-dir")};
+    return autodetected_toolchain()._resource_dir;
 }
 
 /**************************************************************************************************/
 #if HYDE_PLATFORM(APPLE)
 std::filesystem::path autodetect_sysroot_directory() {
+    llvm::TimeTraceScope trace("AutodetectSysroot");
     return std::filesystem::path{exec("xcode-select -p")} /
            "Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk";
 }
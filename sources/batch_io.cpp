@@ -0,0 +1,681 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+// identity
+#include "batch_io.hpp"
+
+// stdc++
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <system_error>
+
+// clang/llvm
+// clang-format off
+#include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "llvm/Support/TimeProfiler.h"
+#include "_clang_include_suffix.hpp" // must be last to re-enable warnings
+// clang-format on
+
+// platform
+#include "config.hpp"
+#if HYDE_FEATURE(IO_URING)
+    #include <fcntl.h>
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+// application
+#include "emitters/yaml_base_emitter.hpp"
+
+/**************************************************************************************************/
+
+namespace {
+
+/**************************************************************************************************/
+
+std::optional<std::string> read_file(const std::filesystem::path& path) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) return std::nullopt;
+    std::stringstream contents;
+    contents << input.rdbuf();
+    return contents.str();
+}
+
+/**************************************************************************************************/
+
+#if HYDE_FEATURE(IO_URING)
+
+/**************************************************************************************************/
+// What `ring::run` leaves as the result of an operation it never submitted, and of one it submitted
+// but never saw complete, should it throw.
+constexpr int not_run_k = -ECANCELED;
+constexpr int in_flight_k = -EINPROGRESS;
+
+/**************************************************************************************************/
+// A minimal io_uring, driven one batch at a time: every operation of a batch is submitted with a
+// single system call, which then waits for all of them to complete.
+class ring {
+public:
+    explicit ring(unsigned entries);
+    ~ring();
+
+    ring(const ring&) = delete;
+    ring& operator=(const ring&) = delete;
+
+    /// Runs `count` operations, `prepare(sqe, i)` setting up the `i`th, and puts the result of each
+    /// in `out_results`, in order: what its system call would return, or a negated `errno`. At most
+    /// as many as the ring has entries are in flight at once. Should this throw, `out_results`
+    /// still holds the results of the operations that completed, and `not_run_k` for those never
+    /// submitted; the rest are `in_flight_k`.
+    template <typename F>
+    void run(std::size_t count, F prepare, std::vector<int>& out_results);
+
+private:
+    void setup(unsigned entries);
+    void release();
+    void submit_and_wait(std::size_t first, unsigned count, std::vector<int>& results);
+
+    int _fd{-1};
+    unsigned _entries{0};
+    void* _sq{MAP_FAILED};
+    std::size_t _sq_size{0};
+    void* _cq{MAP_FAILED};
+    std::size_t _cq_size{0};
+    io_uring_sqe* _sqes{static_cast<io_uring_sqe*>(MAP_FAILED)};
+    std::size_t _sqes_size{0};
+    unsigned* _sq_tail{nullptr};
+    unsigned* _sq_mask{nullptr};
+    unsigned* _sq_array{nullptr};
+    unsigned* _cq_head{nullptr};
+    unsigned* _cq_tail{nullptr};
+    unsigned* _cq_mask{nullptr};
+    io_uring_cqe* _cqes{nullptr};
+};
+
+/**************************************************************************************************/
+
+template <typename T>
+T* at_offset(void* base, std::uint32_t offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+/**************************************************************************************************/
+
+ring::ring(unsigned entries) {
+    try {
+        setup(entries);
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+/**************************************************************************************************/
+
+ring::~ring() { release(); }
+
+/**************************************************************************************************/
+
+void ring::setup(unsigned entries) {
+    io_uring_params params{};
+    _fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+
+    if (_fd < 0) throw std::system_error(errno, std::generic_category(), "io_uring_setup");
+
+    _entries = params.sq_entries;
+    _sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    // Older kernels map the submission and completion queues separately.
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+
+    if (single_mmap) _sq_size = _cq_size = std::max(_sq_size, _cq_size);
+
+    _sq = ::mmap(nullptr, _sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd,
+                 IORING_OFF_SQ_RING);
+    if (_sq == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "mmap");
+
+    if (single_mmap) {
+        _cq = _sq;
+    } else {
+        _cq = ::mmap(nullptr, _cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd,
+                     IORING_OFF_CQ_RING);
+        if (_cq == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "mmap");
+    }
+
+    _sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    _sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE,
+                                              MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES));
+    if (_sqes == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "mmap");
+
+    _sq_tail = at_offset<unsigned>(_sq, params.sq_off.tail);
+    _sq_mask = at_offset<unsigned>(_sq, params.sq_off.ring_mask);
+    _sq_array = at_offset<unsigned>(_sq, params.sq_off.array);
+    _cq_head = at_offset<unsigned>(_cq, params.cq_off.head);
+    _cq_tail = at_offset<unsigned>(_cq, params.cq_off.tail);
+    _cq_mask = at_offset<unsigned>(_cq, params.cq_off.ring_mask);
+    _cqes = at_offset<io_uring_cqe>(_cq, params.cq_off.cqes);
+
+    // Every operation used here has to be supported, or none of them are used.
+    constexpr unsigned probe_ops_k = 256;
+    std::unique_ptr<char[]> buffer(
+        new char[sizeof(io_uring_probe) + probe_ops_k * sizeof(io_uring_probe_op)]());
+    auto* probe = reinterpret_cast<io_uring_probe*>(buffer.get());
+
+    if (::syscall(__NR_io_uring_register, _fd, IORING_REGISTER_PROBE, probe, probe_ops_k) < 0)
+        throw std::system_error(errno, std::generic_category(), "io_uring_register");
+
+    for (const int op : {IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_WRITE,
+                         IORING_OP_CLOSE, IORING_OP_RENAMEAT}) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+            throw std::system_error(ENOSYS, std::generic_category(), "io_uring operation");
+    }
+}
+
+/**************************************************************************************************/
+
+void ring::release() {
+    if (_sqes != MAP_FAILED) ::munmap(_sqes, _sqes_size);
+    if (_cq != MAP_FAILED && _cq != _sq) ::munmap(_cq, _cq_size);
+    if (_sq != MAP_FAILED) ::munmap(_sq, _sq_size);
+    if (_fd >= 0) ::close(_fd);
+}
+
+/**************************************************************************************************/
+
+template <typename F>
+void ring::run(std::size_t count, F prepare, std::vector<int>& out_results) {
+    out_results.assign(count, not_run_k);
+
+    for (std::size_t first = 0; first < count; first += _entries) {
+        const auto batch = static_cast<unsigned>(std::min<std::size_t>(_entries, count - first));
+        // Only this thread touches the submission queue, and the kernel only reads its tail.
+        const unsigned tail = *_sq_tail;
+
+        for (unsigned i = 0; i < batch; ++i) {
+            const unsigned index = (tail + i) & *_sq_mask;
+            io_uring_sqe& sqe = _sqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            prepare(sqe, first + i);
+            sqe.user_data = first + i;
+            _sq_array[index] = index;
+        }
+
+        __atomic_store_n(_sq_tail, tail + batch, __ATOMIC_RELEASE);
+
+        std::fill_n(out_results.begin() + first, batch, in_flight_k);
+        submit_and_wait(first, batch, out_results);
+    }
+}
+
+/**************************************************************************************************/
+
+void ring::submit_and_wait(std::size_t first, unsigned count, std::vector<int>& results) {
+    unsigned to_submit = count;
+    unsigned completed = 0;
+    int error = 0; // of the first failed io_uring_enter
+
+    while (completed < count) {
+        const long entered = ::syscall(__NR_io_uring_enter, _fd, to_submit, 1,
+                                       IORING_ENTER_GETEVENTS, nullptr, 0);
+
+        if (entered < 0 && errno == EINTR) continue;
+
+        if (entered < 0) {
+            // What still cannot be waited for is left in flight.
+            if (error) break;
+
+            // The kernel consumes submissions in order, so the last `to_submit` never ran. Those
+            // that did are waited for, so the caller can tell what they did.
+            error = errno;
+            std::fill_n(results.begin() + first + (count - to_submit), to_submit, not_run_k);
+            count -= to_submit;
+            to_submit = 0;
+        } else {
+            to_submit -= std::min(to_submit, static_cast<unsigned>(entered));
+        }
+
+        unsigned head = *_cq_head;
+        const unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+
+        for (; head != tail; ++head, ++completed) {
+            const io_uring_cqe& cqe = _cqes[head & *_cq_mask];
+            results[cqe.user_data] = cqe.res;
+        }
+
+        __atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    if (error) throw std::system_error(error, std::generic_category(), "io_uring_enter");
+}
+
+/**************************************************************************************************/
+// Calls `f` if the scope is left by an exception.
+template <typename F>
+class on_failure {
+public:
+    explicit on_failure(F f) : _f(std::move(f)) {}
+
+    ~on_failure() {
+        if (std::uncaught_exceptions() > _exceptions) _f();
+    }
+
+    on_failure(const on_failure&) = delete;
+    on_failure& operator=(const on_failure&) = delete;
+
+private:
+    F _f;
+    int _exceptions{std::uncaught_exceptions()};
+};
+
+/**************************************************************************************************/
+// Closes the files of `fds`, the results of an open batch, left open by an abandoned attempt.
+// `closed` holds the results of the close batch, one for each file that opened. A close submitted
+// but not seen to complete is not made again: should it have been made, the descriptor may since
+// have been reused by another thread.
+void close_abandoned(const std::vector<int>& fds, const std::vector<int>& closed) {
+    std::size_t j = 0;
+
+    for (int fd : fds) {
+        if (fd < 0) continue;
+        if (j >= closed.size() || closed[j] == not_run_k) ::close(fd);
+        ++j;
+    }
+}
+
+/**************************************************************************************************/
+// Files are opened, read or written, and closed this many at a time, which keeps well within the
+// limit on open files however many there are. Documentation directories seldom hold more pages.
+constexpr unsigned ring_entries_k = 256;
+
+// The rest of a file that has grown since its size was taken is read this much at a time.
+constexpr std::size_t read_size_k = 64 * 1024;
+
+// The most a single read is asked for; anything past it is read as above.
+constexpr std::size_t max_read_k = 1 << 30;
+
+/**************************************************************************************************/
+// Reads the `count` files of `paths` from `first` into `result`. A file that does not exist is left
+// `std::nullopt`; one that fails in any other way is read again the usual way.
+void read_chunk_io_uring(ring& r,
+                         const std::vector<std::filesystem::path>& paths,
+                         std::size_t first,
+                         std::size_t count,
+                         std::vector<std::optional<std::string>>& result) {
+    std::vector<int> fds;
+    std::vector<int> stated;
+    std::vector<int> sizes;
+    std::vector<int> closed;
+
+    // Should a batch fail, the caller reads the files again the usual way; these must not be left
+    // open.
+    on_failure close_fds([&] { close_abandoned(fds, closed); });
+
+    r.run(count, [&](io_uring_sqe& sqe, std::size_t k) {
+        sqe.opcode = IORING_OP_OPENAT;
+        sqe.fd = AT_FDCWD;
+        sqe.addr = reinterpret_cast<std::uintptr_t>(paths[first + k].c_str());
+        sqe.open_flags = O_RDONLY | O_CLOEXEC;
+    }, fds);
+
+    std::vector<std::size_t> open; // of the chunk, the files that opened
+    std::vector<std::size_t> retry; // and those to read again the usual way
+
+    for (std::size_t k = 0; k < count; ++k) {
+        if (fds[k] >= 0) {
+            open.push_back(k);
+        } else if (fds[k] != -ENOENT) {
+            retry.push_back(k);
+        }
+    }
+
+    // Each buffer is sized to its file, and one byte more: a read that fills it means the file has
+    // grown since, and the rest is read after.
+    std::vector<struct statx> stats(open.size());
+    static const char empty_path_k[] = "";
+
+    r.run(open.size(), [&](io_uring_sqe& sqe, std::size_t j) {
+        sqe.opcode = IORING_OP_STATX;
+        sqe.fd = fds[open[j]];
+        sqe.addr = reinterpret_cast<std::uintptr_t>(empty_path_k);
+        sqe.statx_flags = AT_EMPTY_PATH;
+        sqe.len = STATX_SIZE;
+        sqe.off = reinterpret_cast<std::uintptr_t>(&stats[j]);
+    }, stated);
+
+    std::vector<std::size_t> lengths(open.size());
+
+    for (std::size_t j = 0; j < open.size(); ++j) {
+        const auto size = stated[j] < 0 ? read_size_k : stats[j].stx_size;
+        lengths[j] = std::min<std::size_t>(size + 1, max_read_k);
+        result[first + open[j]].emplace(lengths[j], '\0');
+    }
+
+    r.run(open.size(), [&](io_uring_sqe& sqe, std::size_t j) {
+        const auto k = open[j];
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = fds[k];
+        sqe.addr = reinterpret_cast<std::uintptr_t>(result[first + k]->data());
+        sqe.len = static_cast<std::uint32_t>(lengths[j]);
+        sqe.off = 0;
+    }, sizes);
+
+    for (std::size_t j = 0; j < open.size(); ++j) {
+        const auto k = open[j];
+        std::string& contents = *result[first + k];
+
+        if (sizes[j] < 0) {
+            retry.push_back(k);
+            continue;
+        }
+
+        contents.resize(sizes[j]);
+
+        if (contents.size() < lengths[j]) continue;
+
+        char buffer[read_size_k];
+
+        while (true) {
+            const ssize_t size = ::pread(fds[k], buffer, sizeof(buffer), contents.size());
+            if (size < 0 && errno == EINTR) continue;
+            if (size < 0) retry.push_back(k);
+            if (size <= 0) break;
+            contents.append(buffer, size);
+        }
+    }
+
+    r.run(open.size(), [&](io_uring_sqe& sqe, std::size_t j) {
+        sqe.opcode = IORING_OP_CLOSE;
+        sqe.fd = fds[open[j]];
+    }, closed);
+
+    // A file that could not be opened or read for any reason but its absence (too many open files,
+    // say) is not taken not to exist: the usual way either reads it or fails the same way.
+    for (const auto k : retry) {
+        result[first + k] = read_file(paths[first + k]);
+    }
+}
+
+/**************************************************************************************************/
+
+std::vector<std::optional<std::string>> read_files_io_uring(
+    const std::vector<std::filesystem::path>& paths) {
+    ring r(ring_entries_k);
+    std::vector<std::optional<std::string>> result(paths.size());
+
+    for (std::size_t first = 0; first < paths.size(); first += ring_entries_k) {
+        read_chunk_io_uring(r, paths, first,
+                            std::min<std::size_t>(ring_entries_k, paths.size() - first), result);
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+// Writes the `count` files of `files` from `first` to the temporary files of `temp_paths`, and
+// renames them into place. `fail(i, what, error)` reports the failure of the `i`th file.
+// A file that cannot be opened for the lack of file descriptors is written the usual way instead.
+template <typename F>
+void write_chunk_atomic_io_uring(
+    ring& r,
+    const std::vector<std::pair<std::filesystem::path, std::string>>& files,
+    const std::vector<std::filesystem::path>& temp_paths,
+    std::size_t first,
+    std::size_t count,
+    std::vector<bool>& failures,
+    F fail) {
+    std::vector<int> fds;
+    std::vector<int> sizes;
+    std::vector<int> closed;
+    std::vector<int> renamed;
+
+    // Should a batch fail, the caller writes the files again the usual way; the files opened here
+    // may not be left open.
+    on_failure close_fds([&] { close_abandoned(fds, closed); });
+
+    r.run(count, [&](io_uring_sqe& sqe, std::size_t k) {
+        sqe.opcode = IORING_OP_OPENAT;
+        sqe.fd = AT_FDCWD;
+        sqe.addr = reinterpret_cast<std::uintptr_t>(temp_paths[first + k].c_str());
+        sqe.open_flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+        sqe.len = 0666; // the mode, less the umask, as std::ofstream would have it
+    }, fds);
+
+    std::vector<std::size_t> open;  // of the chunk, the files that opened
+    std::vector<std::size_t> retry; // and those to write again the usual way
+
+    for (std::size_t k = 0; k < count; ++k) {
+        if (fds[k] == -EMFILE || fds[k] == -ENFILE) {
+            retry.push_back(k);
+        } else if (fds[k] < 0) {
+            fail(first + k, "could not open file for output", -fds[k]);
+        } else {
+            open.push_back(k);
+        }
+    }
+
+    r.run(open.size(), [&](io_uring_sqe& sqe, std::size_t j) {
+        const auto i = first + open[j];
+        sqe.opcode = IORING_OP_WRITE;
+        sqe.fd = fds[open[j]];
+        sqe.addr = reinterpret_cast<std::uintptr_t>(files[i].second.data());
+        sqe.len = static_cast<std::uint32_t>(files[i].second.size());
+        sqe.off = 0;
+    }, sizes);
+
+    for (std::size_t j = 0; j < open.size(); ++j) {
+        const auto k = open[j];
+        const std::string& contents = files[first + k].second;
+
+        if (sizes[j] < 0) {
+            fail(first + k, "could not write file", -sizes[j]);
+            continue;
+        }
+
+        // A short write is finished (rarely) the usual way.
+        for (std::size_t written = sizes[j]; written < contents.size();) {
+            const ssize_t size = ::pwrite(fds[k], contents.data() + written,
+                                          contents.size() - written, written);
+            if (size < 0 && errno == EINTR) continue;
+            if (size <= 0) {
+                fail(first + k, "could not write file", size < 0 ? errno : EIO);
+                break;
+            }
+            written += size;
+        }
+    }
+
+    r.run(open.size(), [&](io_uring_sqe& sqe, std::size_t j) {
+        sqe.opcode = IORING_OP_CLOSE;
+        sqe.fd = fds[open[j]];
+    }, closed);
+
+    std::vector<std::size_t> written; // of the files of the whole run, those to rename
+
+    for (std::size_t j = 0; j < open.size(); ++j) {
+        const auto i = first + open[j];
+        if (failures[i]) continue;
+        if (closed[j] < 0) {
+            fail(i, "could not write file", -closed[j]);
+        } else {
+            written.push_back(i);
+        }
+    }
+
+    r.run(written.size(), [&](io_uring_sqe& sqe, std::size_t j) {
+        const auto i = written[j];
+        sqe.opcode = IORING_OP_RENAMEAT;
+        sqe.fd = AT_FDCWD;
+        sqe.addr = reinterpret_cast<std::uintptr_t>(temp_paths[i].c_str());
+        sqe.len = AT_FDCWD;
+        sqe.addr2 = reinterpret_cast<std::uintptr_t>(files[i].first.c_str());
+    }, renamed);
+
+    for (std::size_t j = 0; j < written.size(); ++j) {
+        if (renamed[j] < 0) fail(written[j], "could not replace file", -renamed[j]);
+    }
+
+    // Whatever did not make it into place is not left behind.
+    for (std::size_t k = 0; k < count; ++k) {
+        if (!failures[first + k] || fds[k] < 0) continue;
+        std::error_code ec;
+        std::filesystem::remove(temp_paths[first + k], ec);
+    }
+
+    // Files that could not be opened only for the lack of descriptors are written one at a time,
+    // now that those of the chunk are closed.
+    for (const auto k : retry) {
+        const auto& [path, contents] = files[first + k];
+        failures[first + k] = hyde::write_file_atomic(path, contents);
+    }
+}
+
+/**************************************************************************************************/
+
+std::vector<bool> write_files_atomic_io_uring(
+    const std::vector<std::pair<std::filesystem::path, std::string>>& files) {
+    thread_local std::mt19937 engine{std::random_device()()};
+    ring r(ring_entries_k);
+    const std::size_t count = files.size();
+    std::vector<bool> failures(count, false);
+    std::vector<std::filesystem::path> temp_paths;
+
+    for (const auto& [path, contents] : files) {
+        auto temp_path = path;
+        temp_path += ".hyde_" + std::to_string(engine()) + ".tmp";
+        temp_paths.push_back(std::move(temp_path));
+    }
+
+    const auto fail = [&](std::size_t i, const char* what, int error) {
+        std::cerr << "./" << files[i].first.string() << ": " << what << " ("
+                  << std::strerror(error) << ")\n";
+        failures[i] = true;
+    };
+
+    // Should a batch fail, the caller writes the files again the usual way; the temporary files
+    // created may not be left behind. Those already renamed into place are no longer there to
+    // remove.
+    on_failure remove_temp_files([&] {
+        for (const auto& temp_path : temp_paths) {
+            std::error_code ec;
+            std::filesystem::remove(temp_path, ec);
+        }
+    });
+
+    for (std::size_t first = 0; first < count; first += ring_entries_k) {
+        write_chunk_atomic_io_uring(r, files, temp_paths, first,
+                                    std::min<std::size_t>(ring_entries_k, count - first),
+                                    failures, fail);
+    }
+
+    return failures;
+}
+
+/**************************************************************************************************/
+
+#endif // HYDE_FEATURE(IO_URING)
+
+/**************************************************************************************************/
+
+} // namespace
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+io_backend available_io_backend(io_backend backend) {
+#if HYDE_FEATURE(IO_URING)
+    if (backend == io_backend::io_uring) {
+        // Setting up a ring is cheap, but the answer does not change while the process runs.
+        static const bool available_s = [] {
+            try {
+                ring r(1);
+                return true;
+            } catch (const std::system_error&) {
+                return false;
+            }
+        }();
+
+        return available_s ? io_backend::io_uring : io_backend::sync;
+    }
+#endif
+
+    return io_backend::sync;
+}
+
+/**************************************************************************************************/
+
+std::vector<std::optional<std::string>> read_files(const std::vector<std::filesystem::path>& paths,
+                                                   io_backend backend) {
+    llvm::TimeTraceScope trace("ReadFiles", [&] { return std::to_string(paths.size()); });
+
+#if HYDE_FEATURE(IO_URING)
+    if (backend == io_backend::io_uring && !paths.empty()) {
+        try {
+            return read_files_io_uring(paths);
+        } catch (const std::system_error&) {
+            // E.g., no locked memory left for the ring. The files are read the usual way.
+        }
+    }
+#endif
+
+    std::vector<std::optional<std::string>> result;
+
+    for (const auto& path : paths) {
+        result.push_back(read_file(path));
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+std::vector<bool> write_files_atomic(
+    const std::vector<std::pair<std::filesystem::path, std::string>>& files, io_backend backend) {
+    llvm::TimeTraceScope trace("WriteFiles", [&] { return std::to_string(files.size()); });
+
+#if HYDE_FEATURE(IO_URING)
+    if (backend == io_backend::io_uring && !files.empty()) {
+        try {
+            return write_files_atomic_io_uring(files);
+        } catch (const std::system_error&) {
+            // As above. The failed attempt has closed its files and removed its temporary files,
+            // and every file is written again, replacing any it had already put into place.
+        }
+    }
+#endif
+
+    std::vector<bool> result;
+
+    for (const auto& [path, contents] : files) {
+        result.push_back(write_file_atomic(path, contents));
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
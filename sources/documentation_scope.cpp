@@ -0,0 +1,165 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+// identity
+#include "documentation_scope.hpp"
+
+// stdc++
+#include <unordered_map>
+
+// clang/llvm
+// clang-format off
+#include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/SmallString.h"
+#include "_clang_include_suffix.hpp" // must be last to re-enable warnings
+// clang-format on
+
+/**************************************************************************************************/
+
+namespace {
+
+/**************************************************************************************************/
+// Those of the documentation flags the session passes to clang. (`documentation` takes in the
+// `documentation-deprecated-sync` and `documentation-html` groups.)
+constexpr const char* documentation_groups_k[] = {"documentation", "documentation-pedantic"};
+
+/**************************************************************************************************/
+
+std::filesystem::path canonical_path(const std::filesystem::path& path) {
+    std::error_code ec;
+    const auto absolute = std::filesystem::absolute(path, ec);
+    auto result = std::filesystem::weakly_canonical(absolute, ec);
+    return ec ? absolute.lexically_normal() : result;
+}
+
+/**************************************************************************************************/
+// Turns the documentation diagnostics off at the start of every file entered that is not a source,
+// and back on at the start of every one that is, as `#pragma clang diagnostic` would. Each file
+// starts out as the file that included it was, so the diagnostics are only set where that changes.
+// Clang records a change made in an included file in the files including it, too (at the point of
+// inclusion), so on returning from a file they are set back to what they were in the includer.
+class scope_callbacks : public clang::PPCallbacks {
+public:
+    scope_callbacks(const clang::SourceManager& sm,
+                    clang::DiagnosticsEngine& diagnostics,
+                    const hyde::documentation_scope& scope)
+        : _sm(sm), _diagnostics(diagnostics), _scope(scope) {}
+
+    void FileChanged(clang::SourceLocation loc,
+                     FileChangeReason reason,
+                     clang::SrcMgr::CharacteristicKind kind,
+                     clang::FileID) override {
+        if (reason == ExitFile) {
+            if (_checked.empty()) return;
+
+            const bool left = _checked.back();
+            _checked.pop_back();
+
+            if (left != including()) set(including(), loc);
+
+            return;
+        }
+
+        if (reason != EnterFile) return;
+
+        const bool checked = !clang::SrcMgr::isSystem(kind) && this->checked(_sm.getFileID(loc));
+
+        if (checked != including()) set(checked, loc);
+
+        _checked.push_back(checked);
+    }
+
+private:
+    // Whether the file being parsed is checked. The command line checks everything; the main file
+    // is entered first.
+    bool including() const { return _checked.empty() ? true : _checked.back(); }
+
+    void set(bool checked, clang::SourceLocation loc) {
+        const auto severity = checked ? clang::diag::Severity::Error :
+                                        clang::diag::Severity::Ignored;
+        for (const char* group : documentation_groups_k) {
+            _diagnostics.setSeverityForGroup(clang::diag::Flavor::WarningOrError, group, severity,
+                                             loc);
+        }
+    }
+
+    bool checked(clang::FileID id) {
+        const auto entry = _sm.getFileEntryRefForID(id);
+
+        // The predefines buffer has no file behind it.
+        if (!entry) return false;
+
+        // Headers without include guards are entered once for every time they are included.
+        auto found = _files.find(entry->getUID());
+        if (found != _files.end()) return found->second;
+
+        // Relative names are relative to the compilation, not to this process.
+        llvm::SmallString<256> name(entry->getName());
+        _sm.getFileManager().makeAbsolutePath(name);
+
+        return _files[entry->getUID()] = _scope.checked(name.str().str());
+    }
+
+    const clang::SourceManager& _sm;
+    clang::DiagnosticsEngine& _diagnostics;
+    const hyde::documentation_scope& _scope;
+    std::vector<bool> _checked; // of the files being parsed, innermost last
+    std::unordered_map<unsigned, bool> _files;
+};
+
+/**************************************************************************************************/
+
+} // namespace
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+documentation_scope::documentation_scope(const std::vector<std::string>& sources,
+                                         clang::tooling::SourceFileCallbacks* next)
+    : _next(next) {
+    for (const auto& source : sources) {
+        _sources.insert(canonical_path(source));
+    }
+}
+
+/**************************************************************************************************/
+
+bool documentation_scope::handleBeginSource(clang::CompilerInstance& ci) {
+    ci.getPreprocessor().addPPCallbacks(
+        std::make_unique<scope_callbacks>(ci.getSourceManager(), ci.getDiagnostics(), *this));
+    return _next ? _next->handleBeginSource(ci) : true;
+}
+
+/**************************************************************************************************/
+
+void documentation_scope::handleEndSource() {
+    if (_next) _next->handleEndSource();
+}
+
+/**************************************************************************************************/
+
+bool documentation_scope::checked(const std::filesystem::path& path) const {
+    return _sources.count(canonical_path(path)) != 0;
+}
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
@@ -0,0 +1,80 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+// identity
+#include "file_lock.hpp"
+
+// platform
+#if HYDE_PLATFORM(MICROSOFT)
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/file.h>
+    #include <unistd.h>
+#endif
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+#if HYDE_PLATFORM(MICROSOFT)
+
+file_lock::file_lock(const std::filesystem::path& path) {
+    HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return;
+
+    _handle = handle;
+
+    OVERLAPPED overlapped{};
+    _locked = LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped);
+}
+
+/**************************************************************************************************/
+
+file_lock::~file_lock() {
+    // Closing the handle releases the lock.
+    if (_handle) CloseHandle(static_cast<HANDLE>(_handle));
+}
+
+#else
+
+/**************************************************************************************************/
+
+file_lock::file_lock(const std::filesystem::path& path) {
+    _fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (_fd < 0) return;
+
+    int result;
+    while ((result = ::flock(_fd, LOCK_EX)) != 0 && errno == EINTR) {
+    }
+
+    _locked = result == 0;
+}
+
+/**************************************************************************************************/
+
+file_lock::~file_lock() {
+    // Closing the descriptor releases the lock.
+    if (_fd >= 0) ::close(_fd);
+}
+
+#endif
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
@@ -0,0 +1,339 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+// identity
+#include "include_graph.hpp"
+
+// stdc++
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+
+// clang/llvm
+// clang-format off
+#include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "_clang_include_suffix.hpp" // must be last to re-enable warnings
+// clang-format on
+
+// application
+#include "emitters/yaml_base_emitter.hpp"
+#include "json.hpp"
+
+/**************************************************************************************************/
+
+namespace {
+
+/**************************************************************************************************/
+
+std::filesystem::path canonical_path(const std::filesystem::path& path) {
+    std::error_code ec;
+    const auto absolute = std::filesystem::absolute(path, ec);
+    auto result = std::filesystem::weakly_canonical(absolute, ec);
+    return ec ? absolute.lexically_normal() : result;
+}
+
+/**************************************************************************************************/
+// `path` relative to `root`, or the empty path if it is not under `root`.
+std::filesystem::path relative_to(const std::filesystem::path& path,
+                                  const std::filesystem::path& root) {
+    auto result = path.lexically_relative(root);
+    if (result.empty() || *result.begin() == "..") return std::filesystem::path();
+    return result;
+}
+
+/**************************************************************************************************/
+
+std::filesystem::path graph_file(const std::filesystem::path& graph_dir,
+                                 const std::filesystem::path& relative_source) {
+    return graph_dir / (relative_source.string() + ".json");
+}
+
+/**************************************************************************************************/
+// Hands every file the preprocessor enters (not only those named by an `#include`, which would
+// miss the main file and `-include`d ones) to the recorder.
+class include_callbacks : public clang::PPCallbacks {
+public:
+    include_callbacks(const clang::SourceManager& sm, hyde::include_recorder& recorder)
+        : _sm(sm), _recorder(recorder) {}
+
+    void FileChanged(clang::SourceLocation loc,
+                     FileChangeReason reason,
+                     clang::SrcMgr::CharacteristicKind kind,
+                     clang::FileID) override {
+        if (reason != EnterFile || clang::SrcMgr::isSystem(kind)) return;
+
+        const clang::FileID id = _sm.getFileID(loc);
+        const auto entry = _sm.getFileEntryRefForID(id);
+
+        // The predefines buffer has no file behind it.
+        if (!entry) return;
+
+        // Relative names are relative to the compilation, not to this process.
+        llvm::SmallString<256> name(entry->getName());
+        _sm.getFileManager().makeAbsolutePath(name);
+
+        _recorder.enter(name.str().str(), id == _sm.getMainFileID());
+    }
+
+private:
+    const clang::SourceManager& _sm;
+    hyde::include_recorder& _recorder;
+};
+
+/**************************************************************************************************/
+
+} // namespace
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+include_recorder::include_recorder(std::filesystem::path graph_dir,
+                                   const std::filesystem::path& src_root)
+    : _graph_dir(std::move(graph_dir)), _src_root(canonical_path(src_root)) {}
+
+/**************************************************************************************************/
+
+bool include_recorder::handleBeginSource(clang::CompilerInstance& ci) {
+    _source.clear();
+    _entered.clear();
+    ci.getPreprocessor().addPPCallbacks(
+        std::make_unique<include_callbacks>(ci.getSourceManager(), *this));
+    return true;
+}
+
+/**************************************************************************************************/
+
+void include_recorder::enter(const std::filesystem::path& path, bool is_main_file) {
+    const auto canonical = canonical_path(path);
+
+    if (is_main_file) _source = canonical;
+
+    _entered.insert(canonical);
+}
+
+/**************************************************************************************************/
+
+void include_recorder::handleEndSource() {
+    if (_source.empty()) return;
+
+    _includes[_source] = _entered;
+
+    if (_graph_dir.empty()) return;
+
+    // Sources outside the root are never selected by their dependencies, so there is nothing
+    // worth recording for them.
+    const auto relative = relative_to(_source, _src_root);
+
+    if (relative.empty()) return;
+
+    llvm::TimeTraceScope trace("RecordIncludes", [&] { return _source.string(); });
+
+    // A change outside the root (to a header of a sibling project, say) affects the source all
+    // the same, so those dependencies are kept too, by their absolute paths.
+    std::set<std::string> dependencies;
+
+    for (const auto& path : _entered) {
+        const auto dependency = relative_to(path, _src_root);
+        dependencies.insert(dependency.empty() ? path.generic_string() :
+                                                 dependency.generic_string());
+    }
+
+    json j = json::object();
+    j["source"] = relative.generic_string();
+    j["dependencies"] = std::move(dependencies);
+
+    const auto path = graph_file(_graph_dir, relative);
+    const auto contents = j.dump(2) + '\n';
+
+    // The includes of a source rarely change, so most runs have nothing to write.
+    if (std::filesystem::exists(path) && file_slurp(path) == contents) return;
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    if (ec) {
+        std::cerr << "./" << path.parent_path().string()
+                  << ": directory could not be created (" << ec << ")\n";
+        _failure = true;
+        return;
+    }
+
+    _failure |= write_file_atomic(path, contents);
+}
+
+/**************************************************************************************************/
+
+std::filesystem::path repository_root(const std::filesystem::path& directory) {
+    const auto start = canonical_path(directory);
+
+    for (auto path = start; !path.empty(); path = path.parent_path()) {
+        std::error_code ec;
+        // `.git` is a directory in a clone, but a file in a worktree or submodule.
+        if (std::filesystem::exists(path / ".git", ec)) return path;
+        if (path == path.root_path()) break;
+    }
+
+    return start;
+}
+
+/**************************************************************************************************/
+
+std::vector<std::filesystem::path> read_changed_files(const std::string& path,
+                                                      const std::filesystem::path& base) {
+    std::ifstream file;
+    const bool from_stdin = path == "-";
+
+    if (!from_stdin) {
+        file.open(path);
+        if (!file) throw std::runtime_error("could not read changed files from `" + path + "`");
+    }
+
+    std::istream& input = from_stdin ? std::cin : file;
+    std::vector<std::filesystem::path> result;
+    std::string line;
+
+    while (std::getline(input, line)) {
+        const auto first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos) continue;
+        const auto last = line.find_last_not_of(" \t\r");
+        result.push_back(base / line.substr(first, last - first + 1));
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+std::vector<std::string> affected_sources(const std::vector<std::string>& sources,
+                                          const std::vector<std::filesystem::path>& changed,
+                                          const std::filesystem::path& graph_dir,
+                                          const std::filesystem::path& src_root) {
+    llvm::TimeTraceScope trace("AffectedSources");
+    const auto root = canonical_path(src_root);
+    std::vector<bool> affected(sources.size(), false);
+
+    // The graph is stored by source, from each source to everything it includes. Invert it, so
+    // each changed file leads straight to the sources it affects. Dependencies under the root are
+    // stored relative to it, and those outside it by their absolute paths; both are keyed by the
+    // latter here.
+    std::unordered_map<std::string, std::vector<std::size_t>> included_by;
+
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        const auto relative = relative_to(canonical_path(sources[i]), root);
+
+        if (relative.empty()) {
+            affected[i] = true;
+            continue;
+        }
+
+        const auto path = graph_file(graph_dir, relative);
+        const json j = std::filesystem::exists(path) ?
+                           json::parse(file_slurp(path), nullptr, false) :
+                           json();
+
+        if (!j.is_object() || !j.count("dependencies")) {
+            affected[i] = true;
+            continue;
+        }
+
+        // A change to the source itself always affects it.
+        included_by[(root / relative).generic_string()].push_back(i);
+
+        for (const auto& dependency : j["dependencies"]) {
+            if (!dependency.is_string()) continue;
+            included_by[(root / dependency.get<std::string>()).generic_string()].push_back(i);
+        }
+    }
+
+    // A changed file that is neither in the graph nor on disk is most likely one resolved against
+    // the wrong directory. If none of them can be placed, the selection would be a guess, so every
+    // source is taken to be affected instead.
+    bool placed{changed.empty()};
+
+    for (const auto& path : changed) {
+        const auto canonical = canonical_path(path);
+        const auto found = included_by.find(canonical.generic_string());
+
+        if (found == included_by.end()) {
+            std::error_code ec;
+            placed |= std::filesystem::exists(canonical, ec);
+            continue;
+        }
+
+        placed = true;
+
+        for (const auto i : found->second) {
+            affected[i] = true;
+        }
+    }
+
+    if (!placed) {
+        std::cerr << "WARN: none of the " << changed.size()
+                  << " changed file(s) exist or are in the include graph (is the base of their "
+                     "paths right?); processing every source\n";
+        std::fill(affected.begin(), affected.end(), true);
+    }
+
+    std::vector<std::string> result;
+
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        if (affected[i]) result.push_back(sources[i]);
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+std::vector<std::string> affected_sources(const std::vector<std::string>& sources,
+                                          const std::vector<std::filesystem::path>& changed,
+                                          const include_recorder& recorder) {
+    std::set<std::filesystem::path> changed_set;
+
+    for (const auto& path : changed) {
+        changed_set.insert(canonical_path(path));
+    }
+
+    const auto& includes = recorder.includes();
+    std::vector<std::string> result;
+
+    for (const auto& source : sources) {
+        const auto canonical = canonical_path(source);
+        const auto found = includes.find(canonical);
+
+        // A source that has never been parsed could include anything.
+        const bool affected =
+            changed_set.count(canonical) || found == includes.end() ||
+            std::any_of(found->second.begin(), found->second.end(),
+                        [&](const auto& include) { return changed_set.count(include) != 0; });
+
+        if (affected) result.push_back(source);
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
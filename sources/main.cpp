@@ -10,39 +10,40 @@ written permission of Adobe.
 */
 
 // stdc++
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <optional>
+#include <set>
 #include <sstream>
+#include <string>
+#include <string_view>
 #include <unordered_set>
 
 // clang/llvm
 #include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
-#include "clang/Frontend/FrontendActions.h"
 #include "clang/Tooling/CommonOptionsParser.h"
-#include "clang/Tooling/Tooling.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "_clang_include_suffix.hpp" // must be last to re-enable warnings
 
 // application
 #include "autodetect.hpp"
+#include "batch_io.hpp"
 #include "config.hpp"
+#include "include_graph.hpp"
 #include "json.hpp"
-#include "output_yaml.hpp"
+#include "session.hpp"
+#include "shards.hpp"
+#include "statistics.hpp"
+#include "targets.hpp"
+#include "watch.hpp"
 #include "emitters/yaml_base_emitter_fwd.hpp"
-
-// instead of this, probably have a matcher manager that pushes the json object
-// into the file then does the collation and passes it into jsonAST to do
-// anything it needs to do
-#include "matchers/class_matcher.hpp"
-#include "matchers/enum_matcher.hpp"
-#include "matchers/function_matcher.hpp"
+#include "matchers/declaration_filter.hpp"
 #include "matchers/matcher_fwd.hpp"
-#include "matchers/namespace_matcher.hpp"
-#include "matchers/typealias_matcher.hpp"
-#include "matchers/typedef_matcher.hpp"
 #include "matchers/utilities.hpp"
 
 using namespace clang::tooling;
@@ -54,11 +55,11 @@ namespace {
 
 /**************************************************************************************************/
 
-std::filesystem::path make_absolute(std::filesystem::path path) {
+std::filesystem::path make_absolute(std::filesystem::path path,
+                                    const std::filesystem::path& base) {
     if (path.is_absolute()) return path;
-    static const auto pwd = std::filesystem::current_path();
     std::error_code ec;
-    const auto relative = pwd / path;
+    const auto relative = base / path;
     auto result = weakly_canonical(relative, ec);
 
     if (!ec) {
@@ -70,15 +71,16 @@ std::filesystem::path make_absolute(std::filesystem::path path) {
 
 /**************************************************************************************************/
 
-std::string make_absolute(std::string path_string) {
-    return make_absolute(std::filesystem::path(std::move(path_string))).string();
+std::string make_absolute(std::string path_string, const std::filesystem::path& base) {
+    return make_absolute(std::filesystem::path(std::move(path_string)), base).string();
 }
 
 /**************************************************************************************************/
 
-std::vector<std::string> make_absolute(std::vector<std::string> paths) {
+std::vector<std::string> make_absolute(std::vector<std::string> paths,
+                                       const std::filesystem::path& base) {
     for (auto& path : paths)
-        path = make_absolute(std::move(path));
+        path = make_absolute(std::move(path), base);
 
     return paths;
 }
@@ -196,6 +198,12 @@ static cl::list<std::string> NamespaceBlacklist(
     cl::cat(MyToolCategory),
     cl::CommaSeparated);
 
+static cl::opt<std::string> DeclarationFilter(
+    "hyde-filter",
+    cl::desc("Extract only the declarations let through by the given JSON filter of namespaces, "
+             "names, access, and kinds of symbol (see README)"),
+    cl::cat(MyToolCategory));
+
 static cl::opt<std::string> DriverLanguage(
     "language",
     cl::desc("Override language used for compilation"),
@@ -211,6 +219,13 @@ static cl::opt<bool> ProcessClassMethods(
     cl::desc("Process Class Methods"),
     cl::cat(MyToolCategory),
     cl::ValueDisallowed);
+
+static cl::opt<bool> DocumentInstantiations(
+    "hyde-instantiations",
+    cl::desc("Also document the template instantiations and implicit declarations clang "
+             "synthesizes, not only those spelled in the sources"),
+    cl::cat(MyToolCategory),
+    cl::ValueDisallowed);
     
 static cl::opt<bool> IgnoreExtraneousFiles(
     "ignore-extraneous-files",
@@ -218,6 +233,124 @@ static cl::opt<bool> IgnoreExtraneousFiles(
     cl::cat(MyToolCategory),
     cl::ValueDisallowed);
 
+static cl::opt<std::string> ManifestPath(
+    "hyde-manifest",
+    cl::desc("Write a JSON manifest of the documentation files created, modified, or removed"),
+    cl::cat(MyToolCategory));
+
+static cl::opt<bool> ManifestMerge(
+    "hyde-manifest-merge",
+    cl::desc("Merge into the -hyde-manifest file (under a lock), rather than replacing it"),
+    cl::cat(MyToolCategory),
+    cl::ValueDisallowed);
+
+static cl::opt<bool> UseFingerprints(
+    "hyde-fingerprints",
+    cl::desc("Skip the merge of documentation that is unchanged since the last validate/update"),
+    cl::cat(MyToolCategory),
+    cl::ValueDisallowed);
+
+static cl::opt<hyde::io_backend> IoBackend(
+    "hyde-io",
+    cl::desc("How to read and write the documentation"),
+    cl::values(
+        clEnumValN(hyde::io_backend::io_uring, "io_uring", "In batches through io_uring, where available"),
+        clEnumValN(hyde::io_backend::sync, "sync", "One file at a time (default)")),
+    cl::init(hyde::io_backend::sync),
+    cl::cat(MyToolCategory));
+
+static cl::opt<std::string> TimeTracePath(
+    "hyde-time-trace",
+    cl::desc("Write a Chrome trace (chrome://tracing or Perfetto) of the run to the given file"),
+    cl::cat(MyToolCategory));
+
+static cl::opt<std::string> StatsPath(
+    "hyde-stats",
+    cl::desc("Write statistics of the run to the given file (Prometheus text format if it ends in "
+             "`.prom`, JSON otherwise)"),
+    cl::cat(MyToolCategory));
+
+static cl::opt<std::string> Shard(
+    "hyde-shard",
+    cl::desc("Process only slice i of N (e.g., `2/4`) of the source files, partitioned by a stable "
+             "hash of their paths relative to -hyde-src-root"),
+    cl::cat(MyToolCategory));
+
+static cl::opt<std::string> ShardOutput(
+    "hyde-shard-output",
+    cl::desc("Write the results of this shard to the given file, for --merge-shards (required with "
+             "-hyde-shard in YAML modes)"),
+    cl::cat(MyToolCategory));
+
+static cl::opt<bool> MergeShards(
+    "merge-shards",
+    cl::desc("Merge the -hyde-shard-output files given as sources into one documentation tree, "
+             "and check it for extraneous files"),
+    cl::cat(MyToolCategory),
+    cl::ValueDisallowed);
+
+static cl::opt<std::string> IncludeGraph(
+    "hyde-include-graph",
+    cl::desc("Record the files each source under -hyde-src-root includes in the given "
+             "directory, for -hyde-changed-files"),
+    cl::cat(MyToolCategory));
+
+static cl::opt<std::string> IncludeCache(
+    "hyde-include-cache",
+    cl::desc("Remember in the given file, from one run to the next, the files looked for in the "
+             "include directories and not found"),
+    cl::cat(MyToolCategory));
+
+static cl::opt<std::string> ChangedFiles(
+    "hyde-changed-files",
+    cl::desc("Process only the sources affected by the files listed, one per line, in the given "
+             "file (`-` for stdin), according to -hyde-include-graph"),
+    cl::cat(MyToolCategory));
+
+static cl::opt<std::string> ChangedFilesBase(
+    "hyde-changed-files-base",
+    cl::desc("The directory relative paths in -hyde-changed-files are relative to (by default, "
+             "the root of the git repository hyde is run in)"),
+    cl::cat(MyToolCategory));
+
+static cl::opt<bool> Watch(
+    "watch",
+    cl::desc("Validate or update the documentation of the sources, then keep it up to date as "
+             "they, their includes, or the hyde-config file change"),
+    cl::cat(MyToolCategory),
+    cl::ValueDisallowed);
+
+static cl::opt<unsigned> ExtractionThreads(
+    "hyde-extraction-threads",
+    cl::desc("Extract the declarations of each source across the given number of threads (0 for "
+             "one per core; 1, the default, for none but the one parsing it)"),
+    cl::cat(MyToolCategory),
+    cl::init(1));
+
+static cl::opt<unsigned> PipelineDepth(
+    "hyde-pipeline",
+    cl::desc("Document each source on its own, putting out the documentation of one while those "
+             "after it are parsed, with at most the given number parsed and waiting (YAML modes "
+             "only)"),
+    cl::cat(MyToolCategory),
+    cl::init(0));
+
+static cl::opt<bool> StreamEmission(
+    "hyde-stream",
+    cl::desc("Put out the documentation of each class, enum, and function as soon as it is "
+             "extracted, keeping only a summary of it, to bound the memory taken by large sources "
+             "(YAML modes only)"),
+    cl::cat(MyToolCategory),
+    cl::init(false));
+
+static cl::list<std::string> Targets(
+    "hyde-target",
+    cl::desc("Document the sources into this target as well, parsing them once for all (e.g., "
+             "`mode=update,yaml-dir=docs,access=public`); may be repeated. Targets take their "
+             "access filter and namespace blacklist from the other options unless they give "
+             "their own"),
+    cl::cat(MyToolCategory));
+
 static cl::extrahelp HydeHelp(
     "\nThis tool parses the header source(s) using Clang. To pass arguments to the\n"
     "compiler (e.g., include directories), append them after the `--` token on the\n"
@@ -255,6 +388,8 @@ using optional_path_t = std::optional<std::filesystem::path>;
 /**************************************************************************************************/
 
 optional_path_t find_hyde_config(std::filesystem::path src_file) {
+    llvm::TimeTraceScope trace("FindHydeConfig", [&] { return src_file.string(); });
+
     if (!exists(src_file)) {
         return std::nullopt;
     }
@@ -295,6 +430,7 @@ optional_path_t find_hyde_config(std::filesystem::path src_file) {
 
 std::pair<std::filesystem::path, hyde::json> load_hyde_config(
     std::filesystem::path src_file) try {
+    llvm::TimeTraceScope trace("LoadHydeConfig", [&] { return src_file.string(); });
     optional_path_t hyde_config_path(find_hyde_config(src_file));
 
     if (IsVerbose()) {
@@ -315,9 +451,37 @@ std::pair<std::filesystem::path, hyde::json> load_hyde_config(
 
 /**************************************************************************************************/
 
+// An entry of the `hyde-targets` array of a hyde-config file, as it would be given to
+// `-hyde-target`. Its paths are relative to the hyde-config file.
+std::string target_flag(const hyde::json& target, const std::filesystem::path& working_directory) {
+    std::string result;
+
+    const auto append = [&](const std::string& key, const std::string& value) {
+        if (!result.empty()) result += ',';
+        result += key + '=' + value;
+    };
+
+    for (auto it = target.begin(); it != target.end(); ++it) {
+        if (it.key() == "yaml-dir" || it.key() == "output") {
+            append(it.key(), make_absolute(it.value().get<std::string>(), working_directory));
+        } else if (it.value().is_array()) {
+            for (const auto& value : it.value()) {
+                append(it.key(), value.get<std::string>());
+            }
+        } else {
+            append(it.key(), it.value().get<std::string>());
+        }
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
 struct command_line_args {
     std::vector<std::string> _hyde;
     std::vector<std::string> _clang;
+    std::filesystem::path _working_directory; // that of the hyde-config file, if there is one
 };
 
 command_line_args integrate_hyde_config(int argc, const char** argv) {
@@ -360,7 +524,9 @@ command_line_args integrate_hyde_config(int argc, const char** argv) {
 
     hyde_flags.push_back(argv[0]);
 
-    if (exists(config_dir)) current_path(config_dir);
+    // Paths in the hyde-config file (including those in its clang flags) are relative to it.
+    const std::filesystem::path working_directory =
+        exists(config_dir) ? config_dir : std::filesystem::current_path();
 
     if (config.count("clang_flags")) {
         for (const auto& clang_flag : config["clang_flags"]) {
@@ -370,13 +536,13 @@ command_line_args integrate_hyde_config(int argc, const char** argv) {
 
     if (config.count("hyde-src-root")) {
         const std::string& path_str = config["hyde-src-root"];
-        std::string abs_path_str = make_absolute(path_str);
+        std::string abs_path_str = make_absolute(path_str, working_directory);
         hyde_flags.emplace_back("-hyde-src-root=" + abs_path_str);
     }
 
     if (config.count("hyde-yaml-dir")) {
         const std::string& path_str = config["hyde-yaml-dir"];
-        std::string abs_path_str = make_absolute(path_str);
+        std::string abs_path_str = make_absolute(path_str, working_directory);
         hyde_flags.emplace_back("-hyde-yaml-dir=" + abs_path_str);
     }
 
@@ -385,6 +551,32 @@ command_line_args integrate_hyde_config(int argc, const char** argv) {
         hyde_flags.emplace_back("-hyde-tested-by=" + tested_by);
     }
 
+    if (config.count("hyde-fingerprints") && config["hyde-fingerprints"].get<bool>()) {
+        hyde_flags.emplace_back("-hyde-fingerprints");
+    }
+
+    if (config.count("hyde-include-graph")) {
+        const std::string& path_str = config["hyde-include-graph"];
+        std::string abs_path_str = make_absolute(path_str, working_directory);
+        hyde_flags.emplace_back("-hyde-include-graph=" + abs_path_str);
+    }
+
+    if (config.count("hyde-include-cache")) {
+        const std::string& path_str = config["hyde-include-cache"];
+        std::string abs_path_str = make_absolute(path_str, working_directory);
+        hyde_flags.emplace_back("-hyde-include-cache=" + abs_path_str);
+    }
+
+    if (config.count("hyde-filter")) {
+        hyde_flags.emplace_back("-hyde-filter=" + config["hyde-filter"].dump());
+    }
+
+    if (config.count("hyde-targets")) {
+        for (const auto& target : config["hyde-targets"]) {
+            hyde_flags.emplace_back("-hyde-target=" + target_flag(target, working_directory));
+        }
+    }
+
     hyde_flags.insert(hyde_flags.end(), cli_hyde_flags.begin(), cli_hyde_flags.end());
     clang_flags.insert(clang_flags.end(), cli_clang_flags.begin(), cli_clang_flags.end());
 
@@ -394,6 +586,7 @@ command_line_args integrate_hyde_config(int argc, const char** argv) {
 
     result._hyde = std::move(hyde_flags);
     result._clang = std::move(clang_flags);
+    result._working_directory = working_directory;
 
     return result;
 }
@@ -405,6 +598,7 @@ namespace {
 /**************************************************************************************************/
 
 CommonOptionsParser MakeOptionsParser(int argc, const char** argv) {
+    llvm::TimeTraceScope trace("ParseOptions");
     auto MaybeOptionsParser = CommonOptionsParser::create(argc, argv, MyToolCategory);
     if (!MaybeOptionsParser) {
         throw MaybeOptionsParser.takeError();
@@ -412,14 +606,94 @@ CommonOptionsParser MakeOptionsParser(int argc, const char** argv) {
     return std::move(*MaybeOptionsParser);
 }
 
+/**************************************************************************************************/
+// The time trace and statistics have to be collected before the command line is parsed in order to
+// cover the discovery of the hyde-config file and the parse itself, so look for their options ahead
+// of time. Returns the value of the option `name`, or the empty string if it was not given.
+std::string find_early_option(int argc, const char** argv, std::string_view name) {
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+
+        if (arg == "--") break;
+        if (arg.substr(0, 1) != "-") continue;
+
+        arg.remove_prefix(arg.substr(0, 2) == "--" ? 2 : 1);
+
+        if (arg.substr(0, name.size()) != name) continue;
+
+        arg.remove_prefix(name.size());
+
+        if (arg.empty() && i + 1 < argc) return argv[i + 1];
+        if (arg.substr(0, 1) == "=") return std::string(arg.substr(1));
+    }
+
+    return std::string();
+}
+
+/**************************************************************************************************/
+// Records a trace of the run for as long as it is alive, if a path to write it to was given. Scopes
+// in hyde (and in clang) cost next to nothing while no trace is being recorded.
+struct time_trace {
+    time_trace(std::string path, const char* process_name) : _path(std::move(path)) {
+        if (_path.empty()) return;
+        llvm::timeTraceProfilerInitialize(0, process_name);
+    }
+
+    ~time_trace() {
+        if (_path.empty()) return;
+
+        if (auto error = llvm::timeTraceProfilerWrite(_path, _path)) {
+            std::cerr << "Failed to write time trace (-hyde-time-trace): "
+                      << toString(std::move(error)) << '\n';
+        }
+
+        llvm::timeTraceProfilerCleanup();
+    }
+
+    time_trace(const time_trace&) = delete;
+    time_trace& operator=(const time_trace&) = delete;
+
+private:
+    std::string _path;
+};
+
+/**************************************************************************************************/
+// Writes the statistics of the run when it ends, however it ends, if a path to write them to was
+// given.
+struct statistics_report {
+    explicit statistics_report(std::string path) : _path(std::move(path)) {
+        if (_path.empty()) return;
+        _statistics = std::make_unique<hyde::run_statistics>();
+        _start = hyde::current_cpu_time();
+    }
+
+    ~statistics_report() {
+        if (!_statistics) return;
+        hyde::cpu_time total = hyde::current_cpu_time();
+        total -= _start;
+        _statistics->_phases["total"] = total;
+        (void)hyde::write_statistics(*_statistics, _path);
+    }
+
+    statistics_report(const statistics_report&) = delete;
+    statistics_report& operator=(const statistics_report&) = delete;
+
+    hyde::run_statistics* get() const { return _statistics.get(); }
+
+private:
+    std::string _path;
+    std::unique_ptr<hyde::run_statistics> _statistics;
+    hyde::cpu_time _start;
+};
+
 /**************************************************************************************************/
 // Hyde may accumulate many "fixups" throughout its lifetime. The first of these so far is to move
 // the hyde fields under a `hyde` subfield in the YAML, allowing for other tools' fields to coexist
 // under other values in the same have file.
-bool fixup_have_file_subfield(const std::filesystem::path& path) {
+bool fixup_have_file_subfield(const std::filesystem::path& path, hyde::file_manifest& manifest) {
     // Passing `true` is what's actually causing the fixup.
     const auto parsed = hyde::parse_documentation(path, true);
-    const auto failure = parsed._error || hyde::write_documentation(parsed, path);
+    const auto failure = parsed._error || hyde::write_documentation(parsed, path, &manifest);
 
     if (failure) {
         std::cerr << "Failed to fixup " << path << '\n';
@@ -440,19 +714,149 @@ std::vector<std::string> source_paths(int argc, const char** argv) {
 
 /**************************************************************************************************/
 
+namespace {
+
+/**************************************************************************************************/
+// Documents `sources` with `session`, then puts out what the command line asked for of the result.
+// Throws on failure.
+void process_sources(hyde::session& session,
+                     const std::vector<std::string>& sources,
+                     const std::optional<hyde::shard>& shard) {
+    hyde::session_result result =
+        PipelineDepth ? session.process_each(sources, PipelineDepth) : session.process(sources);
+    const auto& targets = session.options()._targets;
+
+    // The symbols of JSON targets with nowhere else to go are put out here, as `-hyde-json` would.
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        if (targets[i]._mode == hyde::session_mode::json && targets[i]._output.empty()) {
+            std::cout << std::setw(2) << result._json[i] << '\n';
+        }
+    }
+
+    if (targets.empty() && ToolMode == ToolModeJSON) {
+        // The std::setw(2) is for pretty-printing. Remove it for ugly serialization.
+        std::cout << std::setw(2) << result._json << '\n';
+        return;
+    }
+
+    if (!ManifestPath.empty() &&
+        hyde::write_manifest(session.manifest(), session.absolute(ManifestPath.getValue()),
+                             ManifestMerge)) {
+        throw std::runtime_error("failed to write manifest (-hyde-manifest)");
+    }
+
+    if (shard &&
+        hyde::write_shard_result(hyde::shard_result{*shard, result._json, std::move(result._checks)},
+                                 session.options()._yaml_dir,
+                                 session.absolute(ShardOutput.getValue()))) {
+        throw std::runtime_error("failed to write shard results (-hyde-shard-output)");
+    }
+
+    if (EmitJson) {
+        std::cout << result._json << '\n';
+    }
+}
+
+/**************************************************************************************************/
+// Documents every source, then waits for changes to them, to what they include, or to their
+// hyde-config files, and documents again just the sources affected, until interrupted. Each source
+// is processed on its own, as a build would, so one that fails to compile holds up no other.
+void watch_sources(const std::vector<std::string>& sources,
+                   hyde::session& session,
+                   const char** argv) {
+    // Editors save in bursts (a backup, the file, its metadata); wait for them to settle.
+    static constexpr auto quiet_k = std::chrono::milliseconds(100);
+    const hyde::include_recorder& recorder = *session.includes();
+    hyde::file_watcher watcher;
+    std::set<std::filesystem::path> configs;
+
+    for (const auto& source : sources) {
+        if (auto config = find_hyde_config(source)) configs.insert(std::move(*config));
+    }
+
+    const auto process = [&](const std::vector<std::string>& affected) {
+        for (const auto& source : affected) {
+            try {
+                process_sources(session, {source}, std::nullopt);
+            } catch (const std::exception& error) {
+                std::cerr << "./" << source << ": " << error.what() << '\n';
+            }
+        }
+    };
+
+    process(sources);
+
+    while (true) {
+        // What a source includes can change with every run, so keep the watches up to date.
+        for (const auto& config : configs) {
+            watcher.watch(config);
+        }
+        for (const auto& [source, includes] : recorder.includes()) {
+            watcher.watch(source);
+            for (const auto& include : includes) {
+                watcher.watch(include);
+            }
+        }
+        for (const auto& source : sources) {
+            watcher.watch(source);
+        }
+
+        if (IsVerbose()) {
+            std::cout << "INFO: Watching " << watcher.size() << " file(s)\n";
+        }
+
+        const auto changed = watcher.wait(quiet_k);
+
+        if (!changed) return; // interrupted
+
+        // The configuration was folded into the command line at startup, so start over with it.
+        for (const auto& path : *changed) {
+            if (configs.count(path)) {
+                std::cout << "INFO: " << path.string() << " changed; restarting\n";
+                hyde::restart_process(argv);
+            }
+        }
+
+        const auto affected = hyde::affected_sources(sources, *changed, recorder);
+
+        if (IsVerbose()) {
+            std::cout << "INFO: " << affected.size() << " of " << sources.size()
+                      << " source(s) affected by " << changed->size() << " changed file(s)\n";
+        }
+
+        process(affected);
+    }
+}
+
+/**************************************************************************************************/
+
+} // namespace
+
+/**************************************************************************************************/
+
 int main(int argc, const char** argv) try {
     llvm::cl::SetVersionPrinter([](llvm::raw_ostream &OS) {
         OS << "hyde " << hyde::hyde_version() << "; llvm " << LLVM_VERSION_STRING << "\n";
     });
 
-    command_line_args args = integrate_hyde_config(argc, argv);
+    time_trace trace(find_early_option(argc, argv, "hyde-time-trace"), argv[0]);
+    statistics_report report(find_early_option(argc, argv, "hyde-stats"));
+    hyde::run_statistics* const statistics = report.get();
+
+    command_line_args args = [&] {
+        hyde::phase_timer timer(statistics, "config");
+        return integrate_hyde_config(argc, argv);
+    }();
     int new_argc = static_cast<int>(args._hyde.size());
     std::vector<const char*> new_argv(args._hyde.size(), nullptr);
 
     std::transform(args._hyde.begin(), args._hyde.end(), new_argv.begin(),
                    [](const auto& arg) { return arg.c_str(); });
 
-    CommonOptionsParser OptionsParser(MakeOptionsParser(new_argc, &new_argv[0]));
+    CommonOptionsParser OptionsParser = [&] {
+        hyde::phase_timer timer(statistics, "options");
+        return MakeOptionsParser(new_argc, &new_argv[0]);
+    }();
 
     if (UseSystemClang) {
         AutoResourceDirectory = true;
@@ -473,11 +877,12 @@ int main(int argc, const char** argv) try {
         for (const auto& arg : args._clang) {
             std::cout << "INFO:     " << arg << '\n';
         }
-        std::cout << "INFO: Working directory: " << std::filesystem::current_path().string()
-                  << '\n';
+        std::cout << "INFO: Working directory: " << args._working_directory.string() << '\n';
     }
 
-    auto sourcePaths = make_absolute(OptionsParser.getSourcePathList());
+    // Sources given on the command line are relative to where hyde is run.
+    auto sourcePaths =
+        make_absolute(OptionsParser.getSourcePathList(), std::filesystem::current_path());
     // Remove duplicates (CommonOptionsParser is duplicating every single entry)
     std::unordered_set<std::string> s;
     for (std::string i : sourcePaths) {
@@ -485,37 +890,131 @@ int main(int argc, const char** argv) try {
     }
     sourcePaths.assign(s.begin(), s.end());
 
-    if (ToolMode == ToolModeFixupSubfield) {
-        bool failure{false};
+    // The sources of a merge are the results of the shards, and there is nothing to parse.
+    if (MergeShards) {
+        if (YamlDstDir.empty())
+            throw std::runtime_error("no YAML output directory specified (-hyde-yaml-dir)");
 
-        for (const auto& path : sourcePaths) {
-            failure |= fixup_have_file_subfield(path);
+        const std::vector<std::filesystem::path> results(sourcePaths.begin(), sourcePaths.end());
+        hyde::json merged;
+        const bool failure =
+            hyde::merge_shards(results, args._working_directory / YamlDstDir.getValue(),
+                               IgnoreExtraneousFiles, merged);
+        std::cout << std::setw(2) << merged << '\n';
+        return failure ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    if (PipelineDepth && ToolMode == ToolModeJSON)
+        throw std::runtime_error("-hyde-pipeline requires a YAML mode");
+
+    if (StreamEmission && ToolMode == ToolModeJSON)
+        throw std::runtime_error("-hyde-stream requires a YAML mode");
+
+    if (StreamEmission && PipelineDepth)
+        throw std::runtime_error("-hyde-stream cannot be used with -hyde-pipeline");
+
+    if (!Targets.empty()) {
+        if (ToolMode.getNumOccurrences())
+            throw std::runtime_error(
+                "-hyde-target cannot be combined with a mode (e.g., -hyde-update)");
+
+        if (Watch || !Shard.empty() || PipelineDepth || StreamEmission)
+            throw std::runtime_error("-hyde-target cannot be combined with --watch, -hyde-shard, "
+                                     "-hyde-pipeline, or -hyde-stream");
+    }
+
+    if (Watch) {
+        if (ToolMode != ToolModeYAMLValidate && ToolMode != ToolModeYAMLUpdate)
+            throw std::runtime_error("--watch requires -hyde-validate or -hyde-update");
+
+        if (!Shard.empty() || !ChangedFiles.empty())
+            throw std::runtime_error(
+                "--watch cannot be combined with -hyde-shard or -hyde-changed-files");
+    }
+
+    if (!ChangedFiles.empty()) {
+        if (IncludeGraph.empty() || YamlSrcDir.empty())
+            throw std::runtime_error(
+                "-hyde-changed-files requires -hyde-include-graph and -hyde-src-root");
+
+        hyde::phase_timer timer(statistics, "changed-files");
+        const auto base = ChangedFilesBase.empty() ?
+                              hyde::repository_root(std::filesystem::current_path()) :
+                              std::filesystem::absolute(ChangedFilesBase.getValue());
+        const auto changed = hyde::read_changed_files(ChangedFiles, base);
+        const auto total = sourcePaths.size();
+        sourcePaths = hyde::affected_sources(
+            sourcePaths, changed, make_absolute(IncludeGraph.getValue(), args._working_directory),
+            make_absolute(YamlSrcDir.getValue(), args._working_directory));
+
+        if (IsVerbose()) {
+            std::cout << "INFO: " << sourcePaths.size() << " of " << total
+                      << " source(s) affected by " << changed.size() << " changed file(s)\n";
         }
 
-        // In this mode, once the documentation file has been fixed up, we're done.
-        return failure ? EXIT_FAILURE : EXIT_SUCCESS;
+        // Nothing this run documents has changed, so there is nothing to do. (A shard still has
+        // to report in, below.)
+        if (sourcePaths.empty() && Shard.empty()) return EXIT_SUCCESS;
     }
 
-    MatchFinder Finder;
-    hyde::processing_options options{sourcePaths, ToolAccessFilter, NamespaceBlacklist, ProcessClassMethods};
+    std::optional<hyde::shard> shard;
+
+    if (!Shard.empty()) {
+        shard = hyde::parse_shard(Shard);
+
+        if (ToolMode != ToolModeJSON && ShardOutput.empty())
+            throw std::runtime_error("-hyde-shard requires -hyde-shard-output in YAML modes");
+
+        const std::filesystem::path src_root(args._working_directory / YamlSrcDir.getValue());
+        sourcePaths.erase(std::remove_if(sourcePaths.begin(), sourcePaths.end(),
+                                         [&](const std::string& path) {
+                                             return !hyde::in_shard(path, src_root, *shard);
+                                         }),
+                          sourcePaths.end());
 
-    hyde::FunctionInfo function_matcher(options);
-    Finder.addMatcher(hyde::FunctionInfo::GetMatcher(), &function_matcher);
+        // An empty shard still reports in, so the merge can tell it from a missing one.
+        if (sourcePaths.empty()) {
+            if (!ShardOutput.empty() &&
+                hyde::write_shard_result(hyde::shard_result{*shard, hyde::json::object(), {}},
+                                         args._working_directory / YamlDstDir.getValue(),
+                                         args._working_directory / ShardOutput.getValue())) {
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
+        }
+    }
 
-    hyde::EnumInfo enum_matcher(options);
-    Finder.addMatcher(hyde::EnumInfo::GetMatcher(), &enum_matcher);
+    if (statistics) {
+        statistics->_source = sourcePaths.empty() ? std::string() : sourcePaths[0];
+        statistics->_mode = [&] {
+            if (!Targets.empty()) return "targets";
+            switch (ToolMode) {
+                case ToolModeJSON: return "json";
+                case ToolModeYAMLValidate: return "validate";
+                case ToolModeYAMLUpdate: return "update";
+                case ToolModeYAMLTranscribe: return "transcribe";
+                case ToolModeFixupSubfield: return "fixup-subfield";
+            }
+            return "";
+        }();
+    }
 
-    hyde::ClassInfo class_matcher(options);
-    Finder.addMatcher(hyde::ClassInfo::GetMatcher(), &class_matcher);
+    if (ToolMode == ToolModeFixupSubfield) {
+        hyde::file_manifest manifest;
+        bool failure{false};
 
-    hyde::NamespaceInfo namespace_matcher(options);
-    Finder.addMatcher(hyde::NamespaceInfo::GetMatcher(), &namespace_matcher);
+        for (const auto& path : sourcePaths) {
+            failure |= fixup_have_file_subfield(path, manifest);
+        }
 
-    hyde::TypeAliasInfo typealias_matcher(options);
-    Finder.addMatcher(hyde::TypeAliasInfo::GetMatcher(), &typealias_matcher);
+        if (!ManifestPath.empty()) {
+            failure |= hyde::write_manifest(
+                manifest, args._working_directory / ManifestPath.getValue(), ManifestMerge);
+        }
 
-    hyde::TypedefInfo typedef_matcher(options);
-    Finder.addMatcher(hyde::TypedefInfo::GetMatcher(), &typedef_matcher);
+        // In this mode, once the documentation file has been fixed up, we're done.
+        return failure ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
 
     clang::tooling::CommandLineArguments arguments;
 
@@ -540,6 +1039,7 @@ int main(int argc, const char** argv) try {
         if (IsVerbose()) {
             std::cout << "INFO: Sysroot autodetected\n";
         }
+        hyde::phase_timer timer(statistics, "autodetect");
         include_dir = hyde::autodetect_sysroot_directory();
     }
 
@@ -556,7 +1056,10 @@ int main(int argc, const char** argv) try {
     // Specify toolchain includes to the driver
     //
     if (AutoToolchainIncludes) {
-        std::vector<std::filesystem::path> includes = hyde::autodetect_toolchain_paths();
+        const std::vector<std::filesystem::path> includes = [&] {
+            hyde::phase_timer timer(statistics, "autodetect");
+            return hyde::autodetect_toolchain_paths();
+        }();
         if (IsVerbose()) {
             std::cout << "INFO: Toolchain paths autodetected:\n";
         }
@@ -580,6 +1083,7 @@ int main(int argc, const char** argv) try {
             std::cout << "INFO: Resource directory autodetected\n";
         }
 
+        hyde::phase_timer timer(statistics, "autodetect");
         resource_dir = hyde::autodetect_resource_directory();
     } else if (!ArgumentResourceDir.empty()) {
         resource_dir = std::filesystem::path(ArgumentResourceDir.getValue());
@@ -592,110 +1096,62 @@ int main(int argc, const char** argv) try {
         arguments.emplace_back("-resource-dir=" + resource_dir.string());
     }
 
-    // Specify the hyde preprocessor macro
-    arguments.emplace_back("-DADOBE_TOOL_HYDE=1");
-
-    // Have the driver parse comments. See:
-    // https://clang.llvm.org/docs/UsersManual.html#comment-parsing-options
-    // This isn't strictly necessary, as Doxygen comments will be detected
-    // and parsed regardless. Better to be thorough, though.
-    arguments.emplace_back("-fparse-all-comments");
-
-    // Enables some checks built in to the clang driver to ensure comment
-    // documentation matches whatever it is documenting. We also make it
-    // an error because the documentation should be accurate when generated.
-    arguments.emplace_back("-Werror=documentation");
-    arguments.emplace_back("-Werror=documentation-deprecated-sync");
-    arguments.emplace_back("-Werror=documentation-html");
-    arguments.emplace_back("-Werror=documentation-pedantic");
-
-    // Add hyde-specific commands to the Clang Doxygen parser. For hyde, we'll require the first
-    // word to be the hyde field (e.g., `@hyde-owner fosterbrereton`.) Because the Doxygen parser
-    // doesn't consider `-` or `_` as part of the command token, the first word will be
-    // `-owner` in this case, which gives us something parseable, and it reads
-    // reasonably in the code as well.
-    arguments.emplace_back("-fcomment-block-commands=hyde");
-
-    //
-    // Spin up the tool and run it.
-    //
-
-    ClangTool Tool(OptionsParser.getCompilations(), sourcePaths);
-
-    // Clang usually permits the "-x" (aka "--language") flag to "treat subsequent input files as
-    // having type <language>". (See https://clang.llvm.org/docs/ClangCommandLineReference.html).
-    // As noted, the flag only works for _subsequent_ files, and since the input file is passed as
-    // the last parameter before the flag termination token (`--`), we cannot pass the `--language`
-    // flag thereafter and have it apply retroactively. Since the clang driver flags are all passed
-    // after the flag termination token, we have to inject this specific flag early.
-    if (!DriverLanguage.empty()) {
-        std::vector<std::string> prefix_arguments;
-        prefix_arguments.emplace_back("--language=" + DriverLanguage.getValue());
-
-        Tool.appendArgumentsAdjuster(
-            getInsertArgumentAdjuster(prefix_arguments, clang::tooling::ArgumentInsertPosition::BEGIN));
+    hyde::session_options options;
+    options._mode = [&] {
+        switch (ToolMode) {
+            case ToolModeYAMLValidate: return hyde::session_mode::validate;
+            case ToolModeYAMLUpdate: return hyde::session_mode::update;
+            case ToolModeYAMLTranscribe: return hyde::session_mode::transcribe;
+            default: return hyde::session_mode::json;
+        }
+    }();
+    options._working_directory = args._working_directory;
+    options._src_root = YamlSrcDir.getValue();
+    options._yaml_dir = YamlDstDir.getValue();
+    options._access_filter = ToolAccessFilter;
+    options._namespace_blacklist = NamespaceBlacklist;
+    if (!DeclarationFilter.empty()) {
+        const auto filter = hyde::json::parse(DeclarationFilter.getValue(), nullptr, false);
+        if (filter.is_discarded()) throw std::runtime_error("-hyde-filter is not valid JSON");
+        options._filter = hyde::ParseDeclarationFilter(filter);
+    }
+    options._process_class_methods = ProcessClassMethods;
+    options._document_instantiations = DocumentInstantiations;
+    options._extraction_threads = ExtractionThreads;
+    options._streaming = StreamEmission;
+    options._tested_by = TestedBy;
+    options._ignore_extraneous_files = IgnoreExtraneousFiles;
+    // Skipped pages are not merged, so the emitted JSON would not reflect their contents.
+    options._use_fingerprints = UseFingerprints && !EmitJson;
+    options._defer_extraneous_file_check = shard.has_value();
+    options._language = DriverLanguage.getValue();
+    options._clang_arguments = std::move(arguments);
+    options._arguments_adjuster = OptionsParser.getArgumentsAdjuster();
+    options._include_graph = IncludeGraph.getValue();
+    options._include_cache = IncludeCache.getValue();
+    // Watching needs to know what every source includes, whether or not that is kept on disk.
+    options._record_includes = Watch;
+    options._io_backend = hyde::available_io_backend(IoBackend);
+
+    hyde::session_target target_defaults;
+    target_defaults._yaml_dir = options._yaml_dir;
+    target_defaults._access_filter = options._access_filter;
+    target_defaults._namespace_blacklist = options._namespace_blacklist;
+
+    for (const auto& target : Targets) {
+        options._targets.push_back(hyde::parse_target(target, target_defaults));
     }
 
-    Tool.appendArgumentsAdjuster(OptionsParser.getArgumentsAdjuster());
-
-    Tool.appendArgumentsAdjuster(
-        getInsertArgumentAdjuster(arguments, clang::tooling::ArgumentInsertPosition::END));
-
-    if (Tool.run(newFrontendActionFactory(&Finder).get()))
-        throw std::runtime_error("compilation failed.");
-
-    //
-    // Take the results of the tool and process them.
-    //
-
-    hyde::json paths = hyde::json::object();
-    paths["src_root"] = YamlSrcDir;
-    paths["src_path"] = sourcePaths[0]; // Hmm... including multiple sources
-                                        // implies we'd be analyzing multiple
-                                        // subcomponents at the same time. We
-                                        // should account for this at some
-                                        // point.
-
-    hyde::json result = hyde::json::object();
-    result["functions"] = function_matcher.getJSON()["functions"];
-    result["enums"] = enum_matcher.getJSON()["enums"];
-    result["classes"] = class_matcher.getJSON()["classes"];
-    result["namespaces"] = namespace_matcher.getJSON()["namespaces"];
-    result["typealiases"] = typealias_matcher.getJSON()["typealiases"];
-    result["typedefs"] = typedef_matcher.getJSON()["typedefs"];
-    result["paths"] = std::move(paths);
-
-    if (ToolMode == ToolModeJSON) {
-        // The std::setw(2) is for pretty-printing. Remove it for ugly serialization.
-        std::cout << std::setw(2) << result << '\n';
-    } else {
-        if (YamlDstDir.empty())
-            throw std::runtime_error("no YAML output directory specified (-hyde-yaml-dir)");
-
-        std::filesystem::path src_root(YamlSrcDir.getValue());
-        std::filesystem::path dst_root(YamlDstDir.getValue());
-
-        hyde::emit_options emit_options;
-        emit_options._tested_by = TestedBy;
-        emit_options._ignore_extraneous_files = IgnoreExtraneousFiles;
+    options._statistics = statistics;
 
-        const auto yaml_mode = [&]{
-            switch (ToolMode) {
-                case ToolModeYAMLValidate: return hyde::yaml_mode::validate;
-                case ToolModeYAMLUpdate: return hyde::yaml_mode::update;
-                case ToolModeYAMLTranscribe: return hyde::yaml_mode::transcribe;
-                default: throw std::runtime_error("Invalid YAML mode");
-            }
-        }();
+    hyde::session session(std::move(options));
 
-        auto out_emitted = hyde::json::object();
-        output_yaml(std::move(result), std::move(src_root), std::move(dst_root), out_emitted,
-                    yaml_mode, std::move(emit_options));
-        
-        if (EmitJson) {
-            std::cout << out_emitted << '\n';
-        }
+    if (Watch) {
+        watch_sources(sourcePaths, session, argv);
+        return EXIT_SUCCESS;
     }
+
+    process_sources(session, sourcePaths, shard);
 } catch (const std::exception& error) {
     std::cerr << "Fatal error: " << error.what() << '\n';
     return EXIT_FAILURE;
@@ -14,10 +14,20 @@ written permission of Adobe.
 
 // stdc++
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 
 // yaml-cpp
 #include "yaml-cpp/yaml.h"
 
+// clang/llvm
+// clang-format off
+#include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "llvm/Support/TimeProfiler.h"
+#include "_clang_include_suffix.hpp" // must be last to re-enable warnings
+// clang-format on
+
 // application
 #include "emitters/yaml_class_emitter.hpp"
 #include "emitters/yaml_enum_emitter.hpp"
@@ -32,59 +42,251 @@ namespace hyde {
 
 /**************************************************************************************************/
 
+namespace {
+
+/**************************************************************************************************/
+// What is kept of a page put out by `yaml_output` when streaming: enough to find the page, and
+// those of its methods.
+json summarize(const json& emitted) {
+    json result = json::object();
+
+    for (const char* key : {"layout", "title", "documentation_path"}) {
+        if (emitted.count(key)) result[key] = emitted[key];
+    }
+
+    if (emitted.count("methods")) {
+        result["methods"] = json::array();
+        for (const auto& method : emitted["methods"]) {
+            result["methods"].push_back(summarize(method));
+        }
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+} // namespace
+
+/**************************************************************************************************/
+
+struct yaml_output::state {
+    state(const json& paths,
+          std::filesystem::path src_root,
+          std::filesystem::path dst_root,
+          yaml_mode mode,
+          emit_options options,
+          bool streaming)
+        : _src_root(std::move(src_root)), _dst_root(std::move(dst_root)), _mode(mode),
+          _options(std::move(options)), _streaming(streaming), _pages(_options._io_backend,
+                                                                       _options._manifest) {
+        _source["paths"] = paths;
+    }
+
+    const std::filesystem::path _src_root;
+    const std::filesystem::path _dst_root;
+    const yaml_mode _mode;
+    emit_options _options;
+    const bool _streaming;
+    json _source = json::object(); // the "paths" of the symbols, as the emitters look for them
+
+    // Every path the emitters look for, so the extraneous file check can tell which are not.
+    file_checker _checker;
+    fingerprint_cache _fingerprints;
+    transcription_index _transcriptions;
+    page_cache _pages;
+
+    std::optional<yaml_sourcefile_emitter> _sourcefile_emitter;
+    std::optional<yaml_class_emitter> _class_emitter;
+    std::optional<yaml_enum_emitter> _enum_emitter;
+    std::optional<yaml_function_emitter> _function_emitter;
+
+    json _library_emitted = json::object();
+    json _sourcefile_emitted = json::object();
+    json _classes_emitted = json::array();
+    json _enums_emitted = json::array();
+    json _functions_emitted = json::array();
+    bool _failure{false};
+
+    void append(json& into, json&& emitted) {
+        into.push_back(_streaming ? summarize(emitted) : std::move(emitted));
+    }
+};
+
+/**************************************************************************************************/
+
+yaml_output::yaml_output(const json& paths,
+                         std::filesystem::path src_root,
+                         std::filesystem::path dst_root,
+                         yaml_mode mode,
+                         emit_options options,
+                         bool streaming)
+    : _state(std::make_unique<state>(
+          paths, std::move(src_root), std::move(dst_root), mode, std::move(options), streaming)) {
+    state& s = *_state;
+    const json no_inheritance_k;
+
+    s._options._checker = &s._checker;
+
+    // Fingerprints are kept per source file, mirroring the layout of the documentation.
+    // Transcription is expected to touch everything, so there is no point in fingerprinting it.
+    const bool use_fingerprints = s._options._use_fingerprints && mode != yaml_mode::transcribe;
+
+    s._options._fingerprints = use_fingerprints ? &s._fingerprints : nullptr;
+
+    // Renamed symbols are looked up among their sibling directories, so share one index of them
+    // between all the emitters.
+    s._options._transcription_index =
+        mode == yaml_mode::transcribe ? &s._transcriptions : nullptr;
+
+    // The pages of the source file are read all at once up front, and written all at once when the
+    // emitters are done with them. That holds every page at once, so it is not done when streaming.
+    const bool use_pages = mode != yaml_mode::transcribe && !streaming;
+
+    s._options._pages = use_pages ? &s._pages : nullptr;
+
+    s._sourcefile_emitter.emplace(s._src_root, s._dst_root, mode, s._options);
+    s._class_emitter.emplace(s._src_root, s._dst_root, mode, s._options);
+    s._enum_emitter.emplace(s._src_root, s._dst_root, mode, s._options);
+    s._function_emitter.emplace(s._src_root, s._dst_root, mode, s._options, false);
+
+    const auto directory = s._sourcefile_emitter->documentation_directory(s._source);
+
+    if (use_pages) {
+        s._pages.prefetch(directory);
+    }
+
+    if (use_fingerprints) {
+        const auto sub_dst = relative(directory, s._dst_root);
+        s._fingerprints.load(s._dst_root / fingerprints_directory_k / (sub_dst.string() + ".json"));
+    }
+
+    // Process top-level library
+    yaml_library_emitter(s._src_root, s._dst_root, mode, s._options)
+        .emit(s._source, s._library_emitted, no_inheritance_k);
+}
+
+/**************************************************************************************************/
+
+yaml_output::~yaml_output() = default;
+
+/**************************************************************************************************/
+
+void yaml_output::emit_sourcefile(const json& symbols) {
+    state& s = *_state;
+    const json no_inheritance_k;
+    s._failure |= s._sourcefile_emitter->emit(symbols, s._sourcefile_emitted, no_inheritance_k);
+
+    if (s._streaming) s._sourcefile_emitted = summarize(s._sourcefile_emitted);
+}
+
+/**************************************************************************************************/
+
+void yaml_output::emit_class(const json& symbol) {
+    state& s = *_state;
+    const json no_inheritance_k;
+    llvm::TimeTraceScope class_trace("EmitClass", [&] {
+        return symbol.value("qualified_name", std::string());
+    });
+    auto class_emitted = hyde::json::object();
+    s._failure |= s._class_emitter->emit(symbol, class_emitted, no_inheritance_k);
+    s.append(s._classes_emitted, std::move(class_emitted));
+}
+
+/**************************************************************************************************/
+
+void yaml_output::emit_enum(const json& symbol) {
+    state& s = *_state;
+    const json no_inheritance_k;
+    llvm::TimeTraceScope enum_trace("EmitEnum", [&] {
+        return symbol.value("qualified_name", std::string());
+    });
+    auto enum_emitted = hyde::json::object();
+    s._failure |= s._enum_emitter->emit(symbol, enum_emitted, no_inheritance_k);
+    s.append(s._enums_emitted, std::move(enum_emitted));
+}
+
+/**************************************************************************************************/
+
+void yaml_output::emit_function(const std::string& name, const json& overloads) {
+    state& s = *_state;
+    const json no_inheritance_k;
+    llvm::TimeTraceScope function_trace("EmitFunction", [&] { return name; });
+    s._function_emitter->set_key(name);
+    auto function_emitted = hyde::json::object();
+    s._failure |= s._function_emitter->emit(overloads, function_emitted, no_inheritance_k);
+    s.append(s._functions_emitted, std::move(function_emitted));
+}
+
+/**************************************************************************************************/
+
+json yaml_output::finish() {
+    state& s = *_state;
+    auto& sourcefile_emitted = s._sourcefile_emitted;
+
+    if (!s._classes_emitted.empty()) sourcefile_emitted["classes"] = std::move(s._classes_emitted);
+    if (!s._enums_emitted.empty()) sourcefile_emitted["enums"] = std::move(s._enums_emitted);
+    if (!s._functions_emitted.empty())
+        sourcefile_emitted["functions"] = std::move(s._functions_emitted);
+
+    s._library_emitted["sourcefiles"].push_back(std::move(sourcefile_emitted));
+
+    if (s._options._pages) {
+        s._failure |= s._pages.flush();
+    }
+
+    if (s._options._fingerprints) {
+        s._failure |= s._fingerprints.save();
+    }
+
+    // Check for extra files. Always do this last. A sharded run cannot tell the pages of other
+    // shards from extraneous ones, so it records what the check needs for `--merge-shards`.
+    if (s._options._shard_checks) {
+        s._options._shard_checks->_directories.push_back(
+            s._sourcefile_emitter->documentation_directory(s._source));
+        const auto& checked = s._checker.files();
+        s._options._shard_checks->_checked.insert(s._options._shard_checks->_checked.end(),
+                                                  checked.begin(), checked.end());
+    } else if (!s._options._ignore_extraneous_files) {
+        s._failure |= s._sourcefile_emitter->extraneous_file_check();
+    }
+
+    if (s._failure && s._mode == yaml_mode::validate)
+        throw std::runtime_error("YAML documentation failed to validate.");
+
+    return std::move(s._library_emitted);
+}
+
+/**************************************************************************************************/
+
 void output_yaml(json j,
                  const std::filesystem::path& src_root,
                  const std::filesystem::path& dst_root,
                  json& out_emitted,
                  yaml_mode mode,
-                 const emit_options& options) {
-    bool failure{false};
-    auto& library_emitted = out_emitted;
-    const json no_inheritance_k;
+                 emit_options options) {
+    llvm::TimeTraceScope trace("EmitYAML", [&] {
+        return j.value(json::json_pointer("/paths/src_path"), std::string());
+    });
 
-    // Process top-level library
-    yaml_library_emitter(src_root, dst_root, mode, options).emit(j, library_emitted, no_inheritance_k);
+    yaml_output output(j["paths"], src_root, dst_root, mode, std::move(options), false);
 
-    // Process sourcefile
-    yaml_sourcefile_emitter sourcefile_emitter(src_root, dst_root, mode, options);
-    auto sourcefile_emitted = hyde::json::object();
-    failure |= sourcefile_emitter.emit(j, sourcefile_emitted, no_inheritance_k);
+    output.emit_sourcefile(j);
 
-    // Process classes
-    yaml_class_emitter class_emitter(src_root, dst_root, mode, options);
     for (const auto& c : j["classes"]) {
-        auto class_emitted = hyde::json::object();
-        failure |= class_emitter.emit(c, class_emitted, no_inheritance_k);
-        sourcefile_emitted["classes"].push_back(std::move(class_emitted));
+        output.emit_class(c);
     }
 
-    // Process enums
-    yaml_enum_emitter enum_emitter(src_root, dst_root, mode, options);
-    for (const auto& c : j["enums"]) {
-        auto enum_emitted = hyde::json::object();
-        failure |= enum_emitter.emit(c, enum_emitted, no_inheritance_k);
-        sourcefile_emitted["enums"].push_back(std::move(enum_emitted));
+    for (const auto& e : j["enums"]) {
+        output.emit_enum(e);
     }
 
-    // Process functions
-    yaml_function_emitter function_emitter(src_root, dst_root, mode, options, false);
     const auto& functions = j["functions"];
     for (auto it = functions.begin(); it != functions.end(); ++it) {
-        function_emitter.set_key(it.key());
-        auto function_emitted = hyde::json::object();
-        failure |= function_emitter.emit(it.value(), function_emitted, no_inheritance_k);
-        sourcefile_emitted["functions"].push_back(std::move(function_emitted));
+        output.emit_function(it.key(), it.value());
     }
 
-    library_emitted["sourcefiles"].push_back(std::move(sourcefile_emitted));
-
-    // Check for extra files. Always do this last.
-    if (!options._ignore_extraneous_files) {
-        failure |= sourcefile_emitter.extraneous_file_check();
-    }
-
-    if (failure && mode == yaml_mode::validate)
-        throw std::runtime_error("YAML documentation failed to validate.");
+    out_emitted = output.finish();
 }
 
 /**************************************************************************************************/
@@ -0,0 +1,261 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+// identity
+#include "probe_cache.hpp"
+
+// stdc++
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+// clang/llvm
+// clang-format off
+#include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Path.h"
+#include "_clang_include_suffix.hpp" // must be last to re-enable warnings
+// clang-format on
+
+// application
+#include "json.hpp"
+#include "emitters/yaml_base_emitter.hpp"
+
+/**************************************************************************************************/
+
+namespace {
+
+/**************************************************************************************************/
+
+constexpr int version_k = 1;
+
+// How recently a directory may have been modified and still be remembered.
+constexpr std::chrono::seconds settled_k{2};
+
+/**************************************************************************************************/
+
+struct directory {
+    std::int64_t _mtime{0};
+    std::set<std::string> _missing;
+};
+
+/**************************************************************************************************/
+
+std::int64_t to_count(llvm::sys::TimePoint<> time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+/**************************************************************************************************/
+
+} // namespace
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+struct probe_cache::state {
+    std::filesystem::path _path;
+    std::mutex _mutex;
+    std::unordered_map<std::string, directory> _directories;
+    // The modification time of each directory looked in since the last rescan, if it is one.
+    std::unordered_map<std::string, std::optional<std::int64_t>> _mtimes;
+    bool _dirty{false};
+
+    // Of the directory `dir`, as found in `fs`. Expects `_mutex` to be held.
+    std::optional<std::int64_t> mtime(const std::string& dir, llvm::vfs::FileSystem& fs) {
+        auto found = _mtimes.find(dir);
+        if (found != _mtimes.end()) return found->second;
+
+        std::optional<std::int64_t> result;
+        const auto status = fs.status(dir);
+
+        if (status && status->isDirectory()) {
+            result = to_count(status->getLastModificationTime());
+        }
+
+        return _mtimes[dir] = result;
+    }
+
+    bool missing(llvm::StringRef path, llvm::vfs::FileSystem& fs) {
+        const std::string dir = llvm::sys::path::parent_path(path).str();
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        const auto found = _directories.find(dir);
+        if (found == _directories.end()) return false;
+
+        const auto time = mtime(dir, fs);
+
+        return time && *time == found->second._mtime &&
+               found->second._missing.count(llvm::sys::path::filename(path).str());
+    }
+
+    void not_found(llvm::StringRef path, llvm::vfs::FileSystem& fs) {
+        const std::string dir = llvm::sys::path::parent_path(path).str();
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        const auto time = mtime(dir, fs);
+        if (!time) return;
+
+        const auto now = to_count(std::chrono::system_clock::now());
+        if (now - *time < std::chrono::nanoseconds(settled_k).count()) return;
+
+        auto& entry = _directories[dir];
+
+        if (entry._mtime != *time) {
+            entry._mtime = *time;
+            entry._missing.clear();
+        }
+
+        _dirty |= entry._missing.insert(llvm::sys::path::filename(path).str()).second;
+    }
+};
+
+/**************************************************************************************************/
+// Answers that the files the cache knows are missing are not found, without looking for them, and
+// tells the cache of those it looks for and does not find.
+class probing_file_system : public llvm::vfs::ProxyFileSystem {
+public:
+    probing_file_system(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> base,
+                        std::shared_ptr<probe_cache::state> state)
+        : ProxyFileSystem(std::move(base)), _state(std::move(state)) {}
+
+    llvm::ErrorOr<llvm::vfs::Status> status(const llvm::Twine& path) override {
+        return probe(path, [&] { return ProxyFileSystem::status(path); });
+    }
+
+    llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> openFileForRead(
+        const llvm::Twine& path) override {
+        return probe(path, [&] { return ProxyFileSystem::openFileForRead(path); });
+    }
+
+private:
+    template <typename F>
+    auto probe(const llvm::Twine& path, F look) -> decltype(look()) {
+        llvm::SmallString<256> absolute;
+        path.toVector(absolute);
+
+        if (makeAbsolute(absolute)) return look();
+
+        llvm::sys::path::remove_dots(absolute);
+
+        if (_state->missing(absolute, getUnderlyingFS())) {
+            return std::make_error_code(std::errc::no_such_file_or_directory);
+        }
+
+        auto result = look();
+
+        if (result.getError() == std::errc::no_such_file_or_directory) {
+            _state->not_found(absolute, getUnderlyingFS());
+        }
+
+        return result;
+    }
+
+    std::shared_ptr<probe_cache::state> _state;
+};
+
+/**************************************************************************************************/
+
+probe_cache::probe_cache(std::filesystem::path path) : _state(std::make_shared<state>()) {
+    _state->_path = std::move(path);
+
+    if (_state->_path.empty()) return;
+
+    std::ifstream input(_state->_path);
+
+    if (!input) return;
+
+    const json cache = json::parse(input, nullptr, false);
+
+    // Anything else was written by another version of hyde, or is corrupt; start over.
+    if (!cache.is_object() || cache.value("version", 0) != version_k ||
+        !cache.count("directories") || !cache.at("directories").is_object()) {
+        return;
+    }
+
+    for (const auto& [dir, entry] : cache.at("directories").items()) {
+        if (!entry.is_object() || !entry.count("mtime") || !entry.at("mtime").is_number() ||
+            !entry.count("missing") || !entry.at("missing").is_array()) {
+            continue;
+        }
+
+        directory& result = _state->_directories[dir];
+        result._mtime = entry.at("mtime").get<std::int64_t>();
+
+        for (const auto& name : entry.at("missing")) {
+            if (name.is_string()) result._missing.insert(name.get<std::string>());
+        }
+    }
+}
+
+/**************************************************************************************************/
+
+probe_cache::~probe_cache() = default;
+
+/**************************************************************************************************/
+
+llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> probe_cache::file_system(
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> base) {
+    return llvm::makeIntrusiveRefCnt<probing_file_system>(std::move(base), _state);
+}
+
+/**************************************************************************************************/
+
+void probe_cache::rescan() {
+    std::lock_guard<std::mutex> lock(_state->_mutex);
+    _state->_mtimes.clear();
+}
+
+/**************************************************************************************************/
+
+bool probe_cache::save() {
+    json directories = json::object();
+
+    {
+        std::lock_guard<std::mutex> lock(_state->_mutex);
+
+        if (_state->_path.empty() || !_state->_dirty) return false;
+
+        for (const auto& [dir, entry] : _state->_directories) {
+            json& j = directories[dir];
+            j["mtime"] = entry._mtime;
+            j["missing"] = entry._missing;
+        }
+
+        _state->_dirty = false;
+    }
+
+    json cache = json::object();
+    cache["version"] = version_k;
+    cache["directories"] = std::move(directories);
+
+    std::error_code error;
+    std::filesystem::create_directories(_state->_path.parent_path(), error);
+
+    // Names that are not UTF-8 are mangled rather than thrown over; they are never matched again.
+    const std::string contents = cache.dump(-1, ' ', false, json::error_handler_t::replace);
+
+    return write_file_atomic(_state->_path, contents);
+}
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
@@ -0,0 +1,798 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+// identity
+#include "session.hpp"
+
+// stdc++
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// clang/llvm
+// clang-format off
+#include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "_clang_include_suffix.hpp" // must be last to re-enable warnings
+// clang-format on
+
+// application
+#include "bounded_queue.hpp"
+#include "documentation_scope.hpp"
+#include "output_yaml.hpp"
+#include "targets.hpp"
+#include "emitters/yaml_base_emitter.hpp"
+
+// instead of this, probably have a matcher manager that pushes the json object
+// into the file then does the collation and passes it into jsonAST to do
+// anything it needs to do
+#include "matchers/class_matcher.hpp"
+#include "matchers/declaration_filter.hpp"
+#include "matchers/enum_matcher.hpp"
+#include "matchers/function_matcher.hpp"
+#include "matchers/namespace_matcher.hpp"
+#include "matchers/typealias_matcher.hpp"
+#include "matchers/typedef_matcher.hpp"
+
+using namespace clang::ast_matchers;
+using namespace clang::tooling;
+
+/**************************************************************************************************/
+
+namespace {
+
+/**************************************************************************************************/
+// Counts, in `*count` (unless it is null), the declarations that get this far in a matcher.
+AST_MATCHER_P(clang::Decl, counted, std::size_t*, count) {
+    if (count) ++*count;
+    return true;
+}
+
+/**************************************************************************************************/
+// Forwards to a matcher. The ID is what the time spent in the matcher is filed under when the
+// MatchFinder is profiling. The MatchFinder does not profile the end of the translation unit, where
+// the matchers extract what they matched, so that is timed here, and filed under the same ID.
+class timed_callback : public MatchFinder::MatchCallback {
+public:
+    timed_callback(MatchFinder::MatchCallback& callback,
+                   std::string id,
+                   llvm::StringMap<llvm::TimeRecord>& times)
+        : _callback(callback), _id(std::move(id)), _times(times) {}
+
+    void run(const MatchFinder::MatchResult& result) override { _callback.run(result); }
+
+    void onStartOfTranslationUnit() override { _callback.onStartOfTranslationUnit(); }
+
+    void onEndOfTranslationUnit() override {
+        const llvm::TimeRecord start = llvm::TimeRecord::getCurrentTime(true);
+        _callback.onEndOfTranslationUnit();
+        llvm::TimeRecord elapsed = llvm::TimeRecord::getCurrentTime(false);
+        elapsed -= start;
+        _times[_id] += elapsed;
+    }
+
+    std::optional<clang::TraversalKind> getCheckTraversalKind() const override {
+        return _callback.getCheckTraversalKind();
+    }
+
+    llvm::StringRef getID() const override { return _id; }
+
+private:
+    MatchFinder::MatchCallback& _callback;
+    std::string _id;
+    llvm::StringMap<llvm::TimeRecord>& _times;
+};
+
+/**************************************************************************************************/
+
+hyde::cpu_time to_cpu_time(const llvm::TimeRecord& record) {
+    hyde::cpu_time result;
+    result._wall = record.getWallTime();
+    result._user = record.getUserTime();
+    result._system = record.getSystemTime();
+    return result;
+}
+
+/**************************************************************************************************/
+
+std::size_t count_accepted(const hyde::json& matched) {
+    // Functions are grouped by name, with each overload documented separately.
+    if (!matched.is_object()) return matched.size();
+    std::size_t result{0};
+    for (const auto& overloads : matched) {
+        result += overloads.size();
+    }
+    return result;
+}
+
+/**************************************************************************************************/
+
+hyde::yaml_mode to_yaml_mode(hyde::session_mode mode) {
+    switch (mode) {
+        case hyde::session_mode::validate: return hyde::yaml_mode::validate;
+        case hyde::session_mode::update: return hyde::yaml_mode::update;
+        case hyde::session_mode::transcribe: return hyde::yaml_mode::transcribe;
+        default: throw std::runtime_error("Invalid YAML mode");
+    }
+}
+
+/**************************************************************************************************/
+// Whether one of the directories `a` and `b` (both absolute) is, or is within, the other.
+bool nested(std::filesystem::path a, std::filesystem::path b) {
+    a = a.lexically_normal();
+    b = b.lexically_normal();
+
+    // `docs/` and `docs` are the same directory.
+    if (!a.has_filename()) a = a.parent_path();
+    if (!b.has_filename()) b = b.parent_path();
+
+    const auto within = [](const std::filesystem::path& path,
+                           const std::filesystem::path& directory) {
+        return std::mismatch(directory.begin(), directory.end(), path.begin(), path.end()).first ==
+               directory.end();
+    };
+
+    return within(a, b) || within(b, a);
+}
+
+/**************************************************************************************************/
+// Adds the documentation put out for one source to that of the others, as `--merge-shards` does
+// for the results of shards: the library page is the same for every source, so only the first is
+// kept, while the sourcefiles of all of them are.
+void append_result(hyde::session_result& into, hyde::session_result from) {
+    if (into._json.empty()) {
+        into = std::move(from);
+        return;
+    }
+
+    auto& sourcefiles = into._json["sourcefiles"];
+
+    for (auto& sourcefile : from._json["sourcefiles"]) {
+        sourcefiles.push_back(std::move(sourcefile));
+    }
+
+    auto& checks = into._checks;
+    checks._directories.insert(checks._directories.end(), from._checks._directories.begin(),
+                               from._checks._directories.end());
+    checks._checked.insert(checks._checked.end(), from._checks._checked.begin(),
+                           from._checks._checked.end());
+}
+
+/**************************************************************************************************/
+
+} // namespace
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+session::session(session_options options) : _options(std::move(options)) {
+    if (_options._working_directory.empty()) {
+        _options._working_directory = std::filesystem::current_path();
+    }
+
+    _options._working_directory = std::filesystem::absolute(_options._working_directory);
+
+    if (!_options._src_root.empty()) _options._src_root = absolute(_options._src_root);
+    if (!_options._yaml_dir.empty()) _options._yaml_dir = absolute(_options._yaml_dir);
+    if (!_options._include_graph.empty())
+        _options._include_graph = absolute(_options._include_graph);
+    if (!_options._include_cache.empty())
+        _options._include_cache = absolute(_options._include_cache);
+
+    for (auto& target : _options._targets) {
+        if (target._mode != session_mode::json && target._yaml_dir.empty())
+            throw std::runtime_error("no YAML output directory specified for target `" +
+                                     to_string(target) + "`");
+
+        if (!target._yaml_dir.empty()) target._yaml_dir = absolute(target._yaml_dir);
+        if (!target._output.empty()) target._output = absolute(target._output);
+    }
+
+    // The targets are put out at once, each on a thread of its own, so one writing a directory
+    // another reads or writes would race it. Those that only validate may share one.
+    const auto& targets = _options._targets;
+
+    for (auto first = targets.begin(); first != targets.end(); ++first) {
+        if (first->_mode == session_mode::json) continue;
+
+        for (auto second = std::next(first); second != targets.end(); ++second) {
+            if (second->_mode == session_mode::json) continue;
+            if (first->_mode == session_mode::validate && second->_mode == session_mode::validate)
+                continue;
+            if (!nested(first->_yaml_dir, second->_yaml_dir)) continue;
+
+            throw std::runtime_error("targets `" + to_string(*first) + "` and `" +
+                                     to_string(*second) +
+                                     "` share a YAML directory; give each its own `yaml-dir`");
+        }
+    }
+
+    if (!_options._targets.empty() && _options._streaming)
+        throw std::runtime_error("-hyde-target cannot be used with -hyde-stream");
+
+    if (_options._targets.empty() && _options._mode != session_mode::json &&
+        _options._yaml_dir.empty())
+        throw std::runtime_error("no YAML output directory specified (-hyde-yaml-dir)");
+
+    if (!_options._include_graph.empty() && _options._src_root.empty())
+        throw std::runtime_error("-hyde-include-graph requires -hyde-src-root");
+
+    if (!_options._include_graph.empty() || _options._record_includes) {
+        _include_recorder.emplace(_options._include_graph, _options._src_root);
+    }
+
+    // Each source is compiled from the working directory of the session, rather than that of the
+    // process (which is all a compilation database loaded from the command line knows of).
+    _compilations = std::make_unique<FixedCompilationDatabase>(
+        _options._working_directory.string(), std::vector<std::string>());
+
+    // The tool moves the working directory of its file system to that of each compilation. The
+    // real file system would move the working directory of the process instead, so give it one of
+    // its own.
+    _probe_cache.emplace(_options._include_cache);
+    _file_system = _probe_cache->file_system(llvm::vfs::createPhysicalFileSystem());
+}
+
+/**************************************************************************************************/
+
+session::~session() {
+    _probe_cache->save();
+}
+
+/**************************************************************************************************/
+
+std::filesystem::path session::absolute(const std::filesystem::path& path) const {
+    return path.is_absolute() ? path : (_options._working_directory / path).lexically_normal();
+}
+
+/**************************************************************************************************/
+
+session_result session::process(const std::vector<std::string>& sources) {
+    refresh_files();
+
+    if (!_options._targets.empty()) return process_targets(sources);
+
+    if (_options._streaming && _options._mode != session_mode::json) return stream(sources);
+
+    json symbols = parse(sources);
+    session_result out;
+
+    if (_options._mode == session_mode::json) {
+        out._json = std::move(symbols);
+        return out;
+    }
+
+    phase_timer timer(_options._statistics, "emit");
+    emit(std::move(symbols), out);
+
+    return out;
+}
+
+/**************************************************************************************************/
+
+session_result session::process_each(const std::vector<std::string>& sources, std::size_t depth) {
+    if (_options._mode == session_mode::json)
+        throw std::runtime_error("only the YAML modes can be pipelined (-hyde-pipeline)");
+
+    if (_options._streaming)
+        throw std::runtime_error("-hyde-pipeline cannot be used with -hyde-stream");
+
+    if (!_options._targets.empty())
+        throw std::runtime_error("-hyde-pipeline cannot be used with -hyde-target");
+
+    if (sources.empty()) throw std::runtime_error("no sources to process.");
+
+    refresh_files();
+
+    struct parsed {
+        std::string _source;
+        json _symbols;
+    };
+
+    bounded_queue<parsed> queue(depth);
+    session_result out;
+    std::size_t emit_failures{0};
+    cpu_time emit_time;
+
+    // The emitter has the page statistics and the manifest to itself. Its phase is timed apart
+    // from the others, which are only touched by the parser, and added to them once it is done.
+    const bool tracing = llvm::timeTraceProfilerEnabled();
+    std::thread emitter([&] {
+        if (tracing) llvm::timeTraceProfilerInitialize(0, "hyde-emit");
+
+        while (auto item = queue.pop()) {
+            const cpu_time start = current_cpu_time();
+
+            try {
+                session_result result;
+                emit(std::move(item->_symbols), result);
+                append_result(out, std::move(result));
+            } catch (const std::exception& error) {
+                std::cerr << "./" << item->_source << ": " << error.what() << '\n';
+                ++emit_failures;
+            }
+
+            cpu_time elapsed = current_cpu_time();
+            elapsed -= start;
+            emit_time += elapsed;
+        }
+
+        if (tracing) llvm::timeTraceProfilerFinishThread();
+    });
+
+    std::size_t parse_failures{0};
+
+    try {
+        for (const auto& source : sources) {
+            json symbols;
+
+            try {
+                symbols = parse({source});
+            } catch (const std::exception& error) {
+                std::cerr << "./" << source << ": " << error.what() << '\n';
+                ++parse_failures;
+                continue;
+            }
+
+            queue.push(parsed{source, std::move(symbols)});
+        }
+    } catch (...) {
+        queue.close();
+        emitter.join();
+        throw;
+    }
+
+    queue.close();
+    emitter.join();
+
+    if (_options._statistics) _options._statistics->_phases["emit"] += emit_time;
+
+    const std::size_t failures = parse_failures + emit_failures;
+
+    if (failures) {
+        throw std::runtime_error(std::to_string(failures) + " of " +
+                                 std::to_string(sources.size()) + " sources failed.");
+    }
+
+    return out;
+}
+
+/**************************************************************************************************/
+
+session_result session::process_targets(const std::vector<std::string>& sources) {
+    const json symbols = parse(sources);
+    const auto& targets = _options._targets;
+    run_statistics* const statistics = _options._statistics;
+
+    phase_timer timer(statistics, "emit");
+
+    // Each target has a manifest and page statistics of its own, which are added to those of the
+    // session once all are done.
+    std::vector<session_result> results(targets.size());
+    std::vector<file_manifest> manifests(targets.size());
+    std::vector<page_statistics> pages(targets.size());
+    std::vector<std::exception_ptr> errors(targets.size());
+
+    const auto put_out = [&](std::size_t index) {
+        const session_target& target = targets[index];
+        session_result& out = results[index];
+
+        try {
+            json filtered =
+                filter_symbols(symbols, target._access_filter, target._namespace_blacklist);
+
+            if (target._mode == session_mode::json) {
+                if (!target._output.empty() &&
+                    write_file_atomic(target._output, filtered.dump(2) + '\n')) {
+                    throw std::runtime_error("failed to write " + target._output.string());
+                }
+
+                out._json = std::move(filtered);
+                return;
+            }
+
+            emit_options emit_options = make_emit_options(out);
+            emit_options._manifest = &manifests[index];
+            emit_options._statistics = statistics ? &pages[index] : nullptr;
+
+            out._json = json::object();
+            output_yaml(std::move(filtered), _options._src_root, target._yaml_dir, out._json,
+                        to_yaml_mode(target._mode), std::move(emit_options));
+        } catch (...) {
+            errors[index] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 1; i < targets.size(); ++i) {
+        threads.emplace_back(put_out, i);
+    }
+
+    put_out(0);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    session_result result;
+    result._json = json::array();
+    std::size_t failures{0};
+
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        auto& [created, modified, removed] = manifests[i];
+        _manifest._created.insert(_manifest._created.end(), created.begin(), created.end());
+        _manifest._modified.insert(_manifest._modified.end(), modified.begin(), modified.end());
+        _manifest._removed.insert(_manifest._removed.end(), removed.begin(), removed.end());
+
+        if (statistics) {
+            auto& into = statistics->_pages;
+            into._read += pages[i]._read;
+            into._created += pages[i]._created;
+            into._written += pages[i]._written;
+            into._unchanged += pages[i]._unchanged;
+            into._skipped += pages[i]._skipped;
+            into._yaml_bytes += pages[i]._yaml_bytes;
+        }
+
+        if (errors[i]) {
+            try {
+                std::rethrow_exception(errors[i]);
+            } catch (const std::exception& error) {
+                std::cerr << "target `" << to_string(targets[i]) << "`: " << error.what() << '\n';
+            }
+            ++failures;
+        }
+
+        result._json.push_back(std::move(results[i]._json));
+    }
+
+    if (failures) {
+        throw std::runtime_error(std::to_string(failures) + " of " +
+                                 std::to_string(targets.size()) + " targets failed.");
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+session_result session::stream(const std::vector<std::string>& sources) {
+    if (sources.empty()) throw std::runtime_error("no sources to process.");
+
+    run_statistics* const statistics = _options._statistics;
+    session_result out;
+    cpu_time emit_time;
+
+    // The emitting is done in the midst of the parse (whose phase it is also timed in), so it is
+    // timed apart, and added to its own phase at the end.
+    const auto timed = [&](auto&& f) {
+        const cpu_time start = current_cpu_time();
+        f();
+        cpu_time elapsed = current_cpu_time();
+        elapsed -= start;
+        emit_time += elapsed;
+    };
+
+    std::optional<yaml_output> output;
+
+    timed([&] {
+        output.emplace(symbol_paths(sources.front()), _options._src_root, _options._yaml_dir,
+                       to_yaml_mode(_options._mode), make_emit_options(out), true);
+    });
+
+    // The sink is called by clang, which is not to be unwound through; a failure is held until the
+    // parse is done, and the symbols after it are dropped.
+    std::exception_ptr error;
+
+    const symbol_sink sink = [&](std::string_view kind, json symbol) {
+        if (error) return;
+
+        if (statistics) {
+            statistics->_matchers[std::string(kind)]._accepted +=
+                kind == "functions" ? symbol.size() : 1;
+        }
+
+        timed([&] {
+            try {
+                if (kind == "classes") {
+                    output->emit_class(symbol);
+                } else if (kind == "enums") {
+                    output->emit_enum(symbol);
+                } else {
+                    const std::string& name = symbol.front()["short_name"];
+                    output->emit_function(name, symbol);
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+        });
+    };
+
+    json symbols = parse(sources, sink);
+
+    if (error) std::rethrow_exception(error);
+
+    timed([&] {
+        output->emit_sourcefile(symbols);
+        out._json = output->finish();
+    });
+
+    if (statistics) statistics->_phases["emit"] += emit_time;
+
+    return out;
+}
+
+/**************************************************************************************************/
+
+json session::parse(const std::vector<std::string>& sources, const symbol_sink& sink) {
+    std::vector<std::string> sourcePaths;
+
+    for (const auto& source : sources) {
+        sourcePaths.push_back(absolute(source).string());
+    }
+
+    if (sourcePaths.empty()) throw std::runtime_error("no sources to process.");
+
+    run_statistics* const statistics = _options._statistics;
+
+    // With statistics, the finder times each matcher callback.
+    llvm::StringMap<llvm::TimeRecord> matcher_times;
+    MatchFinder::MatchFinderOptions finder_options;
+    std::vector<std::unique_ptr<timed_callback>> timed_callbacks;
+
+    if (statistics) {
+        finder_options.CheckProfiling.emplace(matcher_times);
+    }
+
+    MatchFinder Finder(std::move(finder_options));
+    // With targets, keep what the most permissive of them wants (see `filter_symbols`). The
+    // declaration filter applies to them all, and its access filter, where it is stricter.
+    const auto& targets = _options._targets;
+    const ToolAccessFilter access_filter =
+        targets.empty() ? _options._access_filter : extraction_access_filter(targets);
+    // The symbols themselves are only seen in JSON; the YAML emitters read a few parts of them.
+    const bool emitted_comments_only =
+        targets.empty() ? _options._mode != session_mode::json :
+                          std::none_of(targets.begin(), targets.end(), [](const auto& target) {
+                              return target._mode == session_mode::json;
+                          });
+    processing_options options{sourcePaths,
+                               std::max(access_filter, _options._filter._access_filter),
+                               targets.empty() ? _options._namespace_blacklist :
+                                                 extraction_namespace_blacklist(targets),
+                               _options._process_class_methods,
+                               statistics ? &statistics->_rejections : nullptr,
+                               _options._extraction_threads ?
+                                   _options._extraction_threads :
+                                   std::max(std::thread::hardware_concurrency(), 1u),
+                               sink,
+                               _options._filter,
+                               emitted_comments_only};
+
+    // Declarations the filter turns away are never detailed. Only those turned away by the checks
+    // `StandardDeclInfo` would have made are counted among the rejections.
+    const DeclarationMatcher filter = FilterMatcher(options);
+
+    // Heavily templated sources hold many more instantiations (and implicit members) than they
+    // spell out. Unless they are wanted, no matcher is tried on them, so they are never detailed
+    // only to be thrown away (as `ClassInfo::GetChecks` does with instantiated classes).
+    const clang::TraversalKind traversal = _options._document_instantiations ?
+                                               clang::TK_AsIs :
+                                               clang::TK_IgnoreUnlessSpelledInSource;
+
+    // Every declaration of a matcher's kind is counted as visited by it. Only those that pass its
+    // own checks (`checks`) go on to the filter, so no other is counted among its rejections.
+    const auto add_matcher = [&](const auto& matcher, const DeclarationMatcher& checks,
+                                 MatchFinder::MatchCallback* callback, const char* id) {
+        if (FilterSkips(options._filter, id)) return;
+
+        std::size_t* visited = nullptr;
+
+        if (statistics) {
+            visited = &statistics->_matchers[id]._visited;
+            timed_callbacks.push_back(
+                std::make_unique<timed_callback>(*callback, id, matcher_times));
+            callback = timed_callbacks.back().get();
+        }
+
+        Finder.addMatcher(traverse(traversal, decl(matcher, counted(visited), checks, filter)),
+                          callback);
+    };
+
+    FunctionInfo function_matcher(options);
+    add_matcher(FunctionInfo::GetMatcher(), FunctionInfo::GetChecks(options), &function_matcher,
+                "functions");
+
+    EnumInfo enum_matcher(options);
+    add_matcher(EnumInfo::GetMatcher(), anything(), &enum_matcher, "enums");
+
+    ClassInfo class_matcher(options);
+    add_matcher(ClassInfo::GetMatcher(), ClassInfo::GetChecks(), &class_matcher, "classes");
+
+    NamespaceInfo namespace_matcher(options);
+    add_matcher(NamespaceInfo::GetMatcher(), anything(), &namespace_matcher, "namespaces");
+
+    TypeAliasInfo typealias_matcher(options);
+    add_matcher(TypeAliasInfo::GetMatcher(), anything(), &typealias_matcher, "typealiases");
+
+    TypedefInfo typedef_matcher(options);
+    add_matcher(TypedefInfo::GetMatcher(), anything(), &typedef_matcher, "typedefs");
+
+    //
+    // Spin up the tool and run it.
+    //
+
+    // The file manager is shared with the parses before and after this one (see `refresh_files`),
+    // so each header is looked for in the include directories once, rather than once per parse.
+    ClangTool Tool(*_compilations, sourcePaths, std::make_shared<clang::PCHContainerOperations>(),
+                   _file_system, _files);
+
+    // Clang usually permits the "-x" (aka "--language") flag to "treat subsequent input files as
+    // having type <language>". (See https://clang.llvm.org/docs/ClangCommandLineReference.html).
+    // As noted, the flag only works for _subsequent_ files, and since the input file is passed as
+    // the last parameter before the flag termination token (`--`), we cannot pass the `--language`
+    // flag thereafter and have it apply retroactively. Since the clang driver flags are all passed
+    // after the flag termination token, we have to inject this specific flag early.
+    if (!_options._language.empty()) {
+        std::vector<std::string> prefix_arguments;
+        prefix_arguments.emplace_back("--language=" + _options._language);
+
+        Tool.appendArgumentsAdjuster(
+            getInsertArgumentAdjuster(prefix_arguments, ArgumentInsertPosition::BEGIN));
+    }
+
+    if (_options._arguments_adjuster) {
+        Tool.appendArgumentsAdjuster(_options._arguments_adjuster);
+    }
+
+    CommandLineArguments arguments(_options._clang_arguments.begin(),
+                                   _options._clang_arguments.end());
+
+    // Specify the hyde preprocessor macro
+    arguments.emplace_back("-DADOBE_TOOL_HYDE=1");
+
+    // Have the driver parse comments. See:
+    // https://clang.llvm.org/docs/UsersManual.html#comment-parsing-options
+    // This isn't strictly necessary, as Doxygen comments will be detected
+    // and parsed regardless. Better to be thorough, though.
+    arguments.emplace_back("-fparse-all-comments");
+
+    // Enables some checks built in to the clang driver to ensure comment
+    // documentation matches whatever it is documenting. We also make it
+    // an error because the documentation should be accurate when generated. Only the comments
+    // of the sources are checked (see `documentation_scope`).
+    arguments.emplace_back("-Werror=documentation");
+    arguments.emplace_back("-Werror=documentation-deprecated-sync");
+    arguments.emplace_back("-Werror=documentation-html");
+    arguments.emplace_back("-Werror=documentation-pedantic");
+
+    // Add hyde-specific commands to the Clang Doxygen parser. For hyde, we'll require the first
+    // word to be the hyde field (e.g., `@hyde-owner fosterbrereton`.) Because the Doxygen parser
+    // doesn't consider `-` or `_` as part of the command token, the first word will be
+    // `-owner` in this case, which gives us something parseable, and it reads
+    // reasonably in the code as well.
+    arguments.emplace_back("-fcomment-block-commands=hyde");
+
+    Tool.appendArgumentsAdjuster(
+        getInsertArgumentAdjuster(arguments, ArgumentInsertPosition::END));
+
+    include_recorder* const recorder = _include_recorder ? &*_include_recorder : nullptr;
+
+    // Comments are checked (and so attached and parsed as they are read) only in the sources.
+    documentation_scope scope(sourcePaths, recorder);
+
+    {
+        llvm::TimeTraceScope tool_trace("RunClangTool", [&] { return sourcePaths[0]; });
+        phase_timer timer(statistics, "clang");
+
+        if (Tool.run(newFrontendActionFactory(&Finder, &scope).get()))
+            throw std::runtime_error("compilation failed.");
+    }
+
+    if (recorder && recorder->failed())
+        throw std::runtime_error("failed to record includes (-hyde-include-graph)");
+
+    //
+    // Take the results of the tool and process them.
+    //
+
+    // Hmm... including multiple sources implies we'd be analyzing multiple subcomponents at the
+    // same time. We should account for this at some point.
+    json paths = symbol_paths(sources.front());
+
+    json result = json::object();
+    result["functions"] = function_matcher.getJSON()["functions"];
+    result["enums"] = enum_matcher.getJSON()["enums"];
+    result["classes"] = class_matcher.getJSON()["classes"];
+    result["namespaces"] = namespace_matcher.getJSON()["namespaces"];
+    result["typealiases"] = typealias_matcher.getJSON()["typealiases"];
+    result["typedefs"] = typedef_matcher.getJSON()["typedefs"];
+    result["paths"] = std::move(paths);
+
+    if (statistics) {
+        for (auto& [id, matcher] : statistics->_matchers) {
+            matcher._accepted += count_accepted(result[id]);
+            matcher._time += to_cpu_time(matcher_times.lookup(id));
+        }
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+void session::refresh_files() {
+    // Keep what has been learned of the include directories now, rather than only at the end, as
+    // --watch ends only with Ctrl-C.
+    _probe_cache->save();
+    _probe_cache->rescan();
+    _files =
+        llvm::makeIntrusiveRefCnt<clang::FileManager>(clang::FileSystemOptions(), _file_system);
+}
+
+/**************************************************************************************************/
+
+json session::symbol_paths(const std::string& source) const {
+    json paths = json::object();
+    paths["src_root"] = _options._src_root.string();
+    paths["src_path"] = absolute(source).string();
+    return paths;
+}
+
+/**************************************************************************************************/
+
+emit_options session::make_emit_options(session_result& out) {
+    run_statistics* const statistics = _options._statistics;
+    emit_options emit_options;
+    emit_options._tested_by = _options._tested_by;
+    emit_options._ignore_extraneous_files = _options._ignore_extraneous_files;
+    emit_options._manifest = &_manifest;
+    emit_options._use_fingerprints = _options._use_fingerprints;
+    emit_options._io_backend = _options._io_backend;
+    emit_options._statistics = statistics ? &statistics->_pages : nullptr;
+
+    if (_options._defer_extraneous_file_check) emit_options._shard_checks = &out._checks;
+
+    return emit_options;
+}
+
+/**************************************************************************************************/
+
+void session::emit(json symbols, session_result& out) {
+    emit_options emit_options = make_emit_options(out);
+    out._json = json::object();
+    output_yaml(std::move(symbols), _options._src_root, _options._yaml_dir, out._json,
+                to_yaml_mode(_options._mode), std::move(emit_options));
+}
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
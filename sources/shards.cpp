@@ -0,0 +1,221 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+// identity
+#include "shards.hpp"
+
+// stdc++
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <stdexcept>
+
+// application
+#include "emitters/yaml_base_emitter.hpp"
+#include "emitters/yaml_sourcefile_emitter.hpp"
+
+/**************************************************************************************************/
+
+namespace {
+
+/**************************************************************************************************/
+
+std::string to_string(const hyde::shard& s) {
+    return std::to_string(s._index) + '/' + std::to_string(s._count);
+}
+
+/**************************************************************************************************/
+
+hyde::json relative_paths(const std::vector<std::filesystem::path>& paths,
+                          const std::filesystem::path& root) {
+    hyde::json result = hyde::json::array();
+    const auto normal_root = root.lexically_normal();
+    for (const auto& path : paths) {
+        result.push_back(path.lexically_normal().lexically_relative(normal_root).generic_string());
+    }
+    return result;
+}
+
+/**************************************************************************************************/
+
+std::optional<hyde::json> read_json(const std::filesystem::path& path) {
+    std::ifstream input(path);
+    if (!input) return std::nullopt;
+    hyde::json result = hyde::json::parse(input, nullptr, false);
+    if (result.is_discarded() || !result.is_object()) return std::nullopt;
+    return result;
+}
+
+/**************************************************************************************************/
+
+} // namespace
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+shard parse_shard(const std::string& text) {
+    const auto slash = text.find('/');
+    shard result;
+
+    const auto parse = [&](const char* first, const char* last, std::size_t& out) {
+        auto [end, ec] = std::from_chars(first, last, out);
+        return ec == std::errc() && end == last;
+    };
+
+    if (slash == std::string::npos ||
+        !parse(text.data(), text.data() + slash, result._index) ||
+        !parse(text.data() + slash + 1, text.data() + text.size(), result._count) ||
+        result._count == 0 || result._index == 0 || result._index > result._count) {
+        throw std::runtime_error("invalid shard `" + text + "` (expected i/N, with 1 <= i <= N)");
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+bool in_shard(const std::filesystem::path& src,
+              const std::filesystem::path& src_root,
+              const shard& s) {
+    // The generic form keeps the hash the same on every platform.
+    const std::filesystem::path relative =
+        src_root.empty() ? src.lexically_normal() :
+                           src.lexically_normal().lexically_relative(src_root.lexically_normal());
+
+    return fnv_1a(relative.generic_string()) % s._count == s._index - 1;
+}
+
+/**************************************************************************************************/
+
+bool write_shard_result(const shard_result& result,
+                        const std::filesystem::path& dst_root,
+                        const std::filesystem::path& path) {
+    json j = json::object();
+    j["shard"] = to_string(result._shard);
+    j["emitted"] = result._emitted;
+    j["directories"] = relative_paths(result._checks._directories, dst_root);
+    j["checked"] = relative_paths(result._checks._checked, dst_root);
+
+    // The merge may be waiting on this file, so never let it see a partial one.
+    if (write_file_atomic(path, j.dump() + '\n')) {
+        std::cerr << "./" << path.string() << ": failed to write shard results\n";
+        return true;
+    }
+
+    return false;
+}
+
+/**************************************************************************************************/
+
+bool merge_shards(const std::vector<std::filesystem::path>& results,
+                  const std::filesystem::path& dst_root,
+                  bool ignore_extraneous_files,
+                  json& out_merged) {
+    bool failure{false};
+    const auto root = dst_root.lexically_normal();
+    std::map<std::size_t, std::filesystem::path> seen; // the result read for each shard
+    std::size_t count{0};
+    std::vector<std::filesystem::path> directories;
+    file_checker checker;
+    std::map<std::size_t, json> sourcefiles; // by shard, so the order of `results` is immaterial
+
+    out_merged = json::object();
+
+    for (const auto& path : results) {
+        const auto j = read_json(path);
+
+        if (!j || !j->count("shard")) {
+            std::cerr << "./" << path.string() << ": not a shard result\n";
+            failure = true;
+            continue;
+        }
+
+        const shard s = parse_shard(j->value("shard", std::string()));
+
+        if (count && s._count != count) {
+            std::cerr << "./" << path.string() << ": shard " << to_string(s)
+                      << " is from a run of a different number of shards\n";
+            failure = true;
+            continue;
+        }
+
+        if (const auto found = seen.find(s._index); found != seen.end()) {
+            std::cerr << "./" << path.string() << ": shard " << to_string(s)
+                      << " already has results, in ./" << found->second.string() << '\n';
+            failure = true;
+            continue;
+        }
+
+        count = s._count;
+        seen.emplace(s._index, path);
+
+        // Every shard emits the same library page; take it from the first that has one.
+        const json emitted = j->value("emitted", json::object());
+        for (auto it = emitted.begin(); it != emitted.end(); ++it) {
+            if (it.key() == "sourcefiles") {
+                for (const auto& sourcefile : it.value()) {
+                    sourcefiles[s._index].push_back(sourcefile);
+                }
+            } else if (!out_merged.count(it.key())) {
+                out_merged[it.key()] = it.value();
+            }
+        }
+
+        for (const auto& directory : j->value("directories", json::array())) {
+            const std::string& relative = directory;
+            directories.push_back((root / relative).lexically_normal());
+        }
+
+        for (const auto& checked : j->value("checked", json::array())) {
+            const std::string& relative = checked;
+            checker.insert((root / relative).lexically_normal());
+        }
+    }
+
+    out_merged["sourcefiles"] = json::array();
+    for (auto& [index, shard_sourcefiles] : sourcefiles) {
+        for (auto& sourcefile : shard_sourcefiles) {
+            out_merged["sourcefiles"].push_back(std::move(sourcefile));
+        }
+    }
+
+    for (std::size_t i = 1; i <= count; ++i) {
+        if (!seen.count(i)) {
+            std::cerr << "./" << root.string() << ": no results for shard "
+                      << to_string(shard{i, count}) << '\n';
+            failure = true;
+        }
+    }
+
+    if (ignore_extraneous_files) return failure;
+
+    std::sort(directories.begin(), directories.end());
+    directories.erase(std::unique(directories.begin(), directories.end()), directories.end());
+
+    for (const auto& directory : directories) {
+        if (!std::filesystem::is_directory(directory)) continue;
+        failure |= extraneous_file_check(directory, checker);
+    }
+
+    return failure;
+}
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
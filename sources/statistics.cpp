@@ -0,0 +1,239 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+// identity
+#include "statistics.hpp"
+
+// stdc++
+#include <iostream>
+#include <sstream>
+
+// platform
+#include "config.hpp"
+#if HYDE_PLATFORM(MICROSOFT)
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+// clang/llvm
+// clang-format off
+#include "_clang_include_prefix.hpp" // must be first to disable warnings for clang headers
+#include "llvm/Support/Timer.h"
+#include "_clang_include_suffix.hpp" // must be last to re-enable warnings
+// clang-format on
+
+// application
+#include "emitters/yaml_base_emitter.hpp"
+#include "json.hpp"
+
+/**************************************************************************************************/
+
+namespace {
+
+/**************************************************************************************************/
+
+hyde::json to_json(const hyde::cpu_time& time) {
+    return hyde::json::object({
+        {"wall_seconds", time._wall},
+        {"user_seconds", time._user},
+        {"system_seconds", time._system},
+    });
+}
+
+/**************************************************************************************************/
+
+std::string statistics_json(const hyde::run_statistics& statistics) {
+    hyde::json result = hyde::json::object();
+
+    result["source"] = statistics._source;
+    result["mode"] = statistics._mode;
+
+    result["phases"] = hyde::json::object();
+    for (const auto& [phase, time] : statistics._phases) {
+        result["phases"][phase] = to_json(time);
+    }
+
+    result["matchers"] = hyde::json::object();
+    for (const auto& [matcher, counts] : statistics._matchers) {
+        auto entry = to_json(counts._time);
+        entry["visited"] = counts._visited;
+        entry["accepted"] = counts._accepted;
+        result["matchers"][matcher] = std::move(entry);
+    }
+
+    result["rejections"] = hyde::json::object({
+        {"path", statistics._rejections._path},
+        {"access", statistics._rejections._access},
+        {"namespace", statistics._rejections._namespace},
+    });
+
+    result["pages"] = hyde::json::object({
+        {"read", statistics._pages._read},
+        {"created", statistics._pages._created},
+        {"written", statistics._pages._written},
+        {"unchanged", statistics._pages._unchanged},
+        {"skipped", statistics._pages._skipped},
+        {"yaml_bytes_parsed", statistics._pages._yaml_bytes},
+    });
+
+    result["peak_rss_bytes"] = hyde::peak_rss_bytes();
+
+    return result.dump(2) + '\n';
+}
+
+/**************************************************************************************************/
+// Label values may hold any text, save that backslashes, double quotes, and newlines are escaped.
+std::string prometheus_label_value(const std::string& value) {
+    std::string result;
+
+    for (char c : value) {
+        if (c == '\\') {
+            result += "\\\\";
+        } else if (c == '"') {
+            result += "\\\"";
+        } else if (c == '\n') {
+            result += "\\n";
+        } else {
+            result += c;
+        }
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+// See https://prometheus.io/docs/instrumenting/exposition_formats/. Every value is a gauge, as each
+// file describes a single run. Every sample is labeled with the source and mode of the run, so the
+// files of several runs collected from one directory remain distinct series.
+std::string statistics_prometheus(const hyde::run_statistics& statistics) {
+    std::ostringstream result;
+    const std::string run = "source=\"" + prometheus_label_value(statistics._source) +
+                            "\",mode=\"" + prometheus_label_value(statistics._mode) + '"';
+
+    const auto metric = [&](const char* name, const char* help) {
+        result << "# HELP " << name << ' ' << help << '\n';
+        result << "# TYPE " << name << " gauge\n";
+    };
+
+    const auto sample = [&](const char* name, const std::string& labels, auto value) {
+        result << name << '{' << run << labels << "} " << value << '\n';
+    };
+
+    const auto label = [](const char* name, const std::string& value) {
+        return std::string(",") + name + "=\"" + prometheus_label_value(value) + '"';
+    };
+
+    const auto times = [&](const char* name, const std::string& labels,
+                           const hyde::cpu_time& time) {
+        sample(name, labels + ",clock=\"wall\"", time._wall);
+        sample(name, labels + ",clock=\"user\"", time._user);
+        sample(name, labels + ",clock=\"system\"", time._system);
+    };
+
+    metric("hyde_phase_seconds", "Time spent in each phase of the run.");
+    for (const auto& [phase, time] : statistics._phases) {
+        times("hyde_phase_seconds", label("phase", phase), time);
+    }
+
+    metric("hyde_matcher_seconds", "Time spent in each matcher callback.");
+    for (const auto& [matcher, counts] : statistics._matchers) {
+        times("hyde_matcher_seconds", label("matcher", matcher), counts._time);
+    }
+
+    metric("hyde_matcher_declarations", "Declarations visited and accepted by each matcher.");
+    for (const auto& [matcher, counts] : statistics._matchers) {
+        sample("hyde_matcher_declarations", label("matcher", matcher) + ",outcome=\"visited\"",
+               counts._visited);
+        sample("hyde_matcher_declarations", label("matcher", matcher) + ",outcome=\"accepted\"",
+               counts._accepted);
+    }
+
+    metric("hyde_rejected_declarations", "Declarations rejected, by the check rejecting them.");
+    sample("hyde_rejected_declarations", ",check=\"path\"", statistics._rejections._path);
+    sample("hyde_rejected_declarations", ",check=\"access\"", statistics._rejections._access);
+    sample("hyde_rejected_declarations", ",check=\"namespace\"",
+           statistics._rejections._namespace);
+
+    metric("hyde_pages", "Documentation pages, by what became of them.");
+    sample("hyde_pages", ",outcome=\"read\"", statistics._pages._read);
+    sample("hyde_pages", ",outcome=\"created\"", statistics._pages._created);
+    sample("hyde_pages", ",outcome=\"written\"", statistics._pages._written);
+    sample("hyde_pages", ",outcome=\"unchanged\"", statistics._pages._unchanged);
+    sample("hyde_pages", ",outcome=\"skipped\"", statistics._pages._skipped);
+
+    metric("hyde_yaml_parsed_bytes", "Bytes of existing documentation parsed.");
+    sample("hyde_yaml_parsed_bytes", "", statistics._pages._yaml_bytes);
+
+    metric("hyde_peak_rss_bytes", "Peak resident set size of the run.");
+    sample("hyde_peak_rss_bytes", "", hyde::peak_rss_bytes());
+
+    return result.str();
+}
+
+/**************************************************************************************************/
+
+} // namespace
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+cpu_time current_cpu_time() {
+    const llvm::TimeRecord now = llvm::TimeRecord::getCurrentTime(true);
+    cpu_time result;
+
+    result._wall = now.getWallTime();
+    result._user = now.getUserTime();
+    result._system = now.getSystemTime();
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+std::uint64_t peak_rss_bytes() {
+#if HYDE_PLATFORM(MICROSOFT)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage)) return 0;
+#if HYDE_PLATFORM(APPLE)
+    return static_cast<std::uint64_t>(usage.ru_maxrss); // bytes
+#else
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024; // kilobytes
+#endif
+#endif
+}
+
+/**************************************************************************************************/
+
+bool write_statistics(const run_statistics& statistics, const std::filesystem::path& path) {
+    // The textfile collector may read the file at any time, so never let it see a partial one.
+    if (write_file_atomic(path, path.extension() == ".prom" ? statistics_prometheus(statistics) :
+                                                              statistics_json(statistics))) {
+        std::cerr << "./" << path.string() << ": failed to write statistics\n";
+        return true;
+    }
+
+    return false;
+}
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
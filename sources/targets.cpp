@@ -0,0 +1,261 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+// identity
+#include "targets.hpp"
+
+// stdc++
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+
+// application
+#include "matchers/utilities.hpp"
+
+/**************************************************************************************************/
+
+namespace {
+
+/**************************************************************************************************/
+
+std::string_view to_string(hyde::session_mode mode) {
+    switch (mode) {
+        case hyde::session_mode::json: return "json";
+        case hyde::session_mode::validate: return "validate";
+        case hyde::session_mode::update: return "update";
+        case hyde::session_mode::transcribe: return "transcribe";
+    }
+    return "";
+}
+
+/**************************************************************************************************/
+// Whether a symbol with the given access (as the matchers put it out) passes `filter`. See
+// `AccessCheck`, which this mirrors.
+bool accessible(hyde::ToolAccessFilter filter, const hyde::json& symbol) {
+    if (!symbol.count("access")) return true;
+
+    const std::string& access = symbol["access"];
+
+    switch (filter) {
+        case hyde::ToolAccessFilterPrivate: return true;
+        case hyde::ToolAccessFilterProtected: return access != "private";
+        case hyde::ToolAccessFilterPublic: return access == "public";
+    }
+
+    return true;
+}
+
+/**************************************************************************************************/
+
+struct symbol_filter {
+    hyde::ToolAccessFilter _access_filter;
+    const std::vector<std::string>& _namespace_blacklist;
+
+    bool keeps(const hyde::json& symbol) const {
+        return accessible(_access_filter, symbol) &&
+               !hyde::NamespaceBlacklist(_namespace_blacklist, symbol);
+    }
+};
+
+/**************************************************************************************************/
+// Drops the symbols of `symbols` that `filter` does not keep. They are either an array of symbols,
+// or an object of them by name (as fields are), or of arrays of them (as overloads are). Names left
+// without a symbol are dropped, too.
+void filter_entries(hyde::json& symbols, const symbol_filter& filter) {
+    if (symbols.is_array()) {
+        hyde::json kept = hyde::json::array();
+
+        for (auto& symbol : symbols) {
+            if (filter.keeps(symbol)) kept.push_back(std::move(symbol));
+        }
+
+        symbols = std::move(kept);
+    } else if (symbols.is_object()) {
+        for (auto it = symbols.begin(); it != symbols.end();) {
+            auto& entry = it.value();
+
+            if (entry.is_array()) filter_entries(entry, filter);
+
+            if (entry.is_array() ? entry.empty() : !filter.keeps(entry)) {
+                it = symbols.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+/**************************************************************************************************/
+
+} // namespace
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+session_target parse_target(const std::string& text, const session_target& defaults) {
+    const auto invalid = [&](const std::string& why) {
+        return std::runtime_error("invalid target `" + text + "`: " + why);
+    };
+
+    session_target result = defaults;
+    bool has_mode{false};
+    bool has_blacklist{false};
+    std::string_view rest(text);
+
+    while (!rest.empty()) {
+        const auto comma = rest.find(',');
+        const std::string_view field = rest.substr(0, comma);
+        rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+
+        const auto equals = field.find('=');
+
+        if (equals == std::string_view::npos) throw invalid("expected key=value");
+
+        const std::string_view key = field.substr(0, equals);
+        const std::string value(field.substr(equals + 1));
+
+        if (key == "mode") {
+            if (value == "json") {
+                result._mode = session_mode::json;
+            } else if (value == "validate") {
+                result._mode = session_mode::validate;
+            } else if (value == "update") {
+                result._mode = session_mode::update;
+            } else if (value == "transcribe") {
+                result._mode = session_mode::transcribe;
+            } else {
+                throw invalid("unknown mode `" + value + "`");
+            }
+            has_mode = true;
+        } else if (key == "yaml-dir") {
+            result._yaml_dir = value;
+        } else if (key == "output") {
+            result._output = value;
+        } else if (key == "access") {
+            if (value == "private") {
+                result._access_filter = ToolAccessFilterPrivate;
+            } else if (value == "protected") {
+                result._access_filter = ToolAccessFilterProtected;
+            } else if (value == "public") {
+                result._access_filter = ToolAccessFilterPublic;
+            } else {
+                throw invalid("unknown access `" + value + "`");
+            }
+        } else if (key == "namespace-blacklist") {
+            // A target's blacklist replaces the default one, rather than adding to it.
+            if (!has_blacklist) result._namespace_blacklist.clear();
+            result._namespace_blacklist.push_back(value);
+            has_blacklist = true;
+        } else {
+            throw invalid("unknown key `" + std::string(key) + "`");
+        }
+    }
+
+    if (!has_mode) throw invalid("no mode given");
+
+    if (result._mode == session_mode::json) {
+        result._yaml_dir.clear();
+    } else if (!result._output.empty()) {
+        throw invalid("`output` is for the json mode only");
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+std::string to_string(const session_target& target) {
+    std::string result(::to_string(target._mode));
+
+    if (target._mode != session_mode::json) {
+        result += " " + target._yaml_dir.string();
+    } else if (!target._output.empty()) {
+        result += " " + target._output.string();
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+ToolAccessFilter extraction_access_filter(const std::vector<session_target>& targets) {
+    // The filters go from the most permissive to the least.
+    ToolAccessFilter result{ToolAccessFilterPublic};
+
+    for (const auto& target : targets) {
+        result = std::min(result, target._access_filter);
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+std::vector<std::string> extraction_namespace_blacklist(const std::vector<session_target>& targets) {
+    if (targets.empty()) return std::vector<std::string>();
+
+    std::vector<std::string> result = targets.front()._namespace_blacklist;
+
+    for (const auto& target : targets) {
+        const auto& blacklist = target._namespace_blacklist;
+        const auto wanted = [&](const std::string& ns) {
+            return std::find(blacklist.begin(), blacklist.end(), ns) != blacklist.end();
+        };
+        result.erase(std::remove_if(result.begin(), result.end(), std::not_fn(wanted)),
+                     result.end());
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+json filter_symbols(json symbols,
+                    ToolAccessFilter access_filter,
+                    const std::vector<std::string>& namespace_blacklist) {
+    const symbol_filter filter{access_filter, namespace_blacklist};
+
+    for (const char* kind :
+         {"functions", "enums", "classes", "namespaces", "typealiases", "typedefs"}) {
+        if (!symbols.count(kind)) continue;
+
+        auto& entries = symbols[kind];
+        filter_entries(entries, filter);
+
+        // The matchers leave out the kinds of which they find none.
+        if (entries.empty()) entries = nullptr;
+    }
+
+    if (symbols.count("classes")) {
+        for (auto& clas : symbols["classes"]) {
+            // Every class has its methods, if only an empty object of them.
+            if (clas.count("methods")) filter_entries(clas["methods"], filter);
+
+            for (const char* member : {"fields", "typedefs", "typealiases"}) {
+                if (!clas.count(member)) continue;
+                filter_entries(clas[member], filter);
+                if (clas[member].empty()) clas.erase(member);
+            }
+        }
+    }
+
+    return symbols;
+}
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
@@ -0,0 +1,204 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+// identity
+#include "watch.hpp"
+
+// stdc++
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <system_error>
+
+// platform
+#include "config.hpp"
+#if HYDE_PLATFORM(LINUX)
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+/**************************************************************************************************/
+
+#if HYDE_PLATFORM(LINUX)
+
+/**************************************************************************************************/
+
+namespace {
+
+/**************************************************************************************************/
+
+volatile std::sig_atomic_t interrupted_s{0};
+
+extern "C" void on_interrupt(int) { interrupted_s = 1; }
+
+/**************************************************************************************************/
+
+} // namespace
+
+/**************************************************************************************************/
+
+#endif
+
+/**************************************************************************************************/
+
+namespace hyde {
+
+/**************************************************************************************************/
+
+#if HYDE_PLATFORM(LINUX)
+
+/**************************************************************************************************/
+
+file_watcher::file_watcher() : _fd(::inotify_init1(IN_CLOEXEC)) {
+    if (_fd < 0) throw std::system_error(errno, std::generic_category(), "inotify_init1");
+
+    // Without SA_RESTART, an interrupt ends the wait in `poll` rather than resuming it, so the run
+    // can end normally (and write its statistics and trace).
+    struct sigaction action {};
+    action.sa_handler = on_interrupt;
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+}
+
+/**************************************************************************************************/
+
+file_watcher::~file_watcher() { ::close(_fd); }
+
+/**************************************************************************************************/
+
+void file_watcher::watch(const std::filesystem::path& path) {
+    const auto normal = path.lexically_normal();
+    _files.insert(normal.string());
+
+    const auto directory = normal.parent_path();
+
+    if (_descriptors.count(directory.string())) return;
+
+    static constexpr std::uint32_t mask_k =
+        IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+    // A directory that does not exist (yet) is tried again on the next call.
+    const int descriptor = ::inotify_add_watch(_fd, directory.c_str(), mask_k);
+
+    if (descriptor < 0) return;
+
+    _descriptors[directory.string()] = descriptor;
+    _directories[descriptor] = directory;
+}
+
+/**************************************************************************************************/
+
+std::optional<std::vector<std::filesystem::path>> file_watcher::wait(
+    std::chrono::milliseconds quiet) {
+    std::set<std::filesystem::path> changed;
+    int timeout = -1; // until the first change
+
+    while (true) {
+        pollfd ready_fd{_fd, POLLIN, 0};
+        const int ready = ::poll(&ready_fd, 1, timeout);
+
+        if (interrupted_s) return std::nullopt;
+
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            throw std::system_error(errno, std::generic_category(), "poll");
+        }
+
+        if (ready == 0) break; // quiet for long enough
+
+        alignas(inotify_event) char buffer[64 * 1024];
+        const ssize_t size = ::read(_fd, buffer, sizeof(buffer));
+
+        if (size < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+
+        for (const char* p = buffer; p < buffer + size;) {
+            const auto& event = *reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + event.len;
+
+            // Events were dropped, so anything could have changed.
+            if (event.mask & IN_Q_OVERFLOW) {
+                for (const auto& file : _files) {
+                    changed.insert(file);
+                }
+                continue;
+            }
+
+            // The directory is gone; it is watched again if it comes back.
+            if (event.mask & IN_IGNORED) {
+                auto found = _directories.find(event.wd);
+                if (found == _directories.end()) continue;
+                _descriptors.erase(found->second.string());
+                _directories.erase(found);
+                continue;
+            }
+
+            if (!event.len) continue;
+
+            const auto found = _directories.find(event.wd);
+
+            if (found == _directories.end()) continue;
+
+            auto path = found->second / event.name;
+
+            if (_files.count(path.string())) changed.insert(std::move(path));
+        }
+
+        if (!changed.empty()) timeout = static_cast<int>(quiet.count());
+    }
+
+    return std::vector<std::filesystem::path>(changed.begin(), changed.end());
+}
+
+/**************************************************************************************************/
+
+void restart_process(const char** argv) {
+    ::execv("/proc/self/exe", const_cast<char* const*>(argv));
+    throw std::system_error(errno, std::generic_category(), "failed to restart");
+}
+
+/**************************************************************************************************/
+
+#else
+
+/**************************************************************************************************/
+
+file_watcher::file_watcher() {
+    throw std::runtime_error("--watch is only supported on Linux");
+}
+
+file_watcher::~file_watcher() = default;
+
+void file_watcher::watch(const std::filesystem::path&) {}
+
+std::optional<std::vector<std::filesystem::path>> file_watcher::wait(std::chrono::milliseconds) {
+    return std::nullopt;
+}
+
+void restart_process(const char**) {
+    throw std::runtime_error("restarting is only supported on Linux");
+}
+
+/**************************************************************************************************/
+
+#endif
+
+/**************************************************************************************************/
+
+} // namespace hyde
+
+/**************************************************************************************************/
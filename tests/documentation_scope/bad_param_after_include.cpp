@@ -0,0 +1,21 @@
+/*
+Copyright 2018 Adobe
+All Rights Reserved.
+
+NOTICE: Adobe permits you to use, modify, and distribute this file in
+accordance with the terms of the Adobe license agreement accompanying
+it. If you have received this file from a source other than Adobe,
+then your use, modification, or distribution of it requires the prior
+written permission of Adobe.
+*/
+
+// The documentation diagnostics are off while <vector> is parsed, and must be back on once it has
+// been: the comment of `sum` below documents a parameter it does not have, which hyde must report.
+
+#include <vector>
+
+/// Adds up `values`.
+/// @param values the values to add up
+/// @param missing a parameter `sum` does not have
+/// @return The sum of `values`.
+int sum(const std::vector<int>& values);
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+
+# Copyright 2018 Adobe
+# All Rights Reserved.
+
+# NOTICE: Adobe permits you to use, modify, and distribute this file in
+# accordance with the terms of the Adobe license agreement accompanying
+# it. If you have received this file from a source other than Adobe,
+# then your use, modification, or distribution of it requires the prior
+# written permission of Adobe.
+
+"""Runs hyde over one of test_files/ in JSON mode, extracting on a single thread and then on
+several, and checks that both runs put out the same JSON.
+
+Extraction spread across threads must put its results in the order a single thread would, so any
+difference, even one of order alone, fails the test.
+
+Threads take declarations in chunks of 16, so the test files, with fewer than that of each kind,
+never have two threads extracting at once. With --corpus the test runs over a header generated by
+benchmarks/generate_corpus.py instead, with thousands of declarations.
+"""
+
+import argparse
+import difflib
+import os
+import subprocess
+import sys
+import tempfile
+
+#---------------------------------------------------------------------------------------------------
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+SRC_ROOT = os.path.join(ROOT, "test_files")
+GENERATE_CORPUS = os.path.join(ROOT, "benchmarks", "generate_corpus.py")
+
+# Enough of each kind of declaration to keep eight threads busy.
+CORPUS_ARGS = ["--headers=1", "--namespaces=4", "--classes=16", "--methods=8", "--functions=64",
+               "--enums=8", "--comment-lines=1"]
+
+#---------------------------------------------------------------------------------------------------
+
+def run_json(args, path, threads):
+    """The JSON hyde puts out for the file at `path` when extracting on `threads` threads, or None
+    if hyde failed."""
+    command = [args.hyde, "-hyde-json", f"-hyde-extraction-threads={threads}"] + args.hyde_flag
+    command += [path, "--"]
+    process = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    if process.returncode != 0:
+        sys.stderr.write(process.stderr.decode("utf-8", "replace"))
+        print(f"{args.name}: hyde -hyde-extraction-threads={threads} exited with "
+              f"{process.returncode}")
+        return None
+    return process.stdout.decode("utf-8", "replace")
+
+#---------------------------------------------------------------------------------------------------
+
+def compare(args, path):
+    """Runs hyde over the file at `path` on one thread and on --threads, and compares the two."""
+    expected = run_json(args, path, 1)
+    actual = run_json(args, path, args.threads)
+    if expected is None or actual is None:
+        return 1
+
+    if expected != actual:
+        sys.stdout.writelines(difflib.unified_diff(expected.splitlines(keepends=True),
+                                                   actual.splitlines(keepends=True),
+                                                   "threads=1", f"threads={args.threads}"))
+        print(f"{args.name}: JSON differs between 1 and {args.threads} extraction threads")
+        return 1
+
+    print(f"{args.name}: JSON matches between 1 and {args.threads} extraction threads")
+    return 0
+
+#---------------------------------------------------------------------------------------------------
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--hyde", required=True, help="path to the hyde executable")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--file", help="the test file, relative to test_files/")
+    source.add_argument("--corpus", action="store_true",
+                        help="run over a generated header with thousands of declarations")
+    parser.add_argument("--threads", type=int, default=8,
+                        help="threads to compare a single thread's extraction against")
+    parser.add_argument("--hyde-flag", action="append", default=[],
+                        help="an extra flag for hyde (repeatable)")
+    args = parser.parse_args()
+
+    if not args.corpus:
+        args.name = args.file
+        return compare(args, os.path.join(SRC_ROOT, args.file))
+
+    args.name = "corpus"
+    with tempfile.TemporaryDirectory(prefix="hyde_threads_") as corpus:
+        subprocess.run([sys.executable, GENERATE_CORPUS, corpus] + CORPUS_ARGS, check=True)
+        return compare(args, os.path.join(corpus, "bench_0.hpp"))
+
+#---------------------------------------------------------------------------------------------------
+
+if __name__ == "__main__":
+    sys.exit(main())
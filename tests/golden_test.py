@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+
+# Copyright 2018 Adobe
+# All Rights Reserved.
+
+# NOTICE: Adobe permits you to use, modify, and distribute this file in
+# accordance with the terms of the Adobe license agreement accompanying
+# it. If you have received this file from a source other than Adobe,
+# then your use, modification, or distribution of it requires the prior
+# written permission of Adobe.
+
+"""Runs hyde over one of test_files/ in one mode and checks both its output and its cost.
+
+    json      the JSON written to stdout must match tests/golden/<file>.json
+    validate  docs/libraries must validate cleanly
+    update    updating a scratch copy of docs/libraries must leave it byte for byte unchanged
+
+The wall time (best of --repeat runs) and peak RSS of the run are then held to the baseline stored
+for the case in tests/golden/baselines.json: exceeding either by more than --threshold (a fraction)
+fails the test. No goldens or baselines are committed yet, so until they are recorded a JSON case
+without a golden exits with SKIP (77), which CTest reports as skipped, and a case without a
+baseline passes with its budget unchecked. Pass
+--record (or build the hyde_record_goldens target) to write the golden and baseline from this run
+instead of checking against them.
+"""
+
+import argparse
+import filecmp
+import json
+import os
+import shutil
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "benchmarks"))
+
+from run_benchmarks import run_timed  # noqa: E402
+
+#---------------------------------------------------------------------------------------------------
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+SRC_ROOT = os.path.join(ROOT, "test_files")
+DOCS_ROOT = os.path.join(ROOT, "docs", "libraries")
+GOLDEN_ROOT = os.path.join(ROOT, "tests", "golden")
+BASELINES = os.path.join(GOLDEN_ROOT, "baselines.json")
+
+# The exit status CTest is told (by SKIP_RETURN_CODE) means the case was skipped.
+SKIP = 77
+
+#---------------------------------------------------------------------------------------------------
+
+def hyde_command(args, yaml_dir):
+    command = [args.hyde, f"-hyde-{args.mode}"] + args.hyde_flag
+    if args.mode != "json":
+        command += [f"-hyde-src-root={SRC_ROOT}", f"-hyde-yaml-dir={yaml_dir}"]
+    command += [os.path.join(SRC_ROOT, args.file), "--"]
+    return command
+
+#---------------------------------------------------------------------------------------------------
+
+def tree_differences(expected, actual):
+    """Paths, relative to the roots, that differ between the two directory trees."""
+    result = []
+    comparison = filecmp.dircmp(expected, actual)
+
+    def walk(comparison, prefix):
+        for name in comparison.left_only:
+            result.append(os.path.join(prefix, name) + " (removed)")
+        for name in comparison.right_only:
+            result.append(os.path.join(prefix, name) + " (added)")
+        for name in comparison.common_files:
+            if not filecmp.cmp(os.path.join(comparison.left, name),
+                               os.path.join(comparison.right, name), shallow=False):
+                result.append(os.path.join(prefix, name) + " (changed)")
+        for name, sub in comparison.subdirs.items():
+            walk(sub, os.path.join(prefix, name))
+
+    walk(comparison, "")
+    return result
+
+#---------------------------------------------------------------------------------------------------
+
+def check_output(args, scratch):
+    """Runs the case. Returns (status, wall seconds, peak RSS bytes), where status is 0 on a
+    match, 1 on a mismatch, and SKIP when there is no golden to compare against."""
+    # validate and update work on a copy of the docs, so neither can disturb the checkout or
+    # another test running at the same time.
+    yaml_dir = os.path.join(scratch, "libraries")
+    output_path = os.path.join(scratch, "stdout.json")
+    wall = None
+    rss = 0
+
+    for _ in range(args.repeat):
+        if args.mode != "json":
+            shutil.rmtree(yaml_dir, ignore_errors=True)
+            shutil.copytree(DOCS_ROOT, yaml_dir)
+        with open(output_path, "w", encoding="utf-8") as stdout:
+            code, elapsed, peak, stderr = run_timed(hyde_command(args, yaml_dir), stdout)
+        if code != 0:
+            sys.stderr.write(stderr)
+            print(f"{args.file}: hyde -hyde-{args.mode} exited with {code}")
+            return 1, elapsed, peak
+        wall = elapsed if wall is None else min(wall, elapsed)
+        rss = max(rss, peak)
+
+    if args.mode != "json":
+        differences = tree_differences(DOCS_ROOT, yaml_dir)
+        for difference in differences:
+            print(f"./docs/libraries/{difference}")
+        return (1 if differences else 0), wall, rss
+
+    # Paths are made relative to the repository, so the golden does not depend on where it was
+    # checked out.
+    with open(output_path, encoding="utf-8") as f:
+        output = f.read().replace(ROOT + os.sep, "")
+
+    golden = os.path.join(GOLDEN_ROOT, args.file + ".json")
+    if args.record:
+        os.makedirs(GOLDEN_ROOT, exist_ok=True)
+        with open(golden, "w", encoding="utf-8") as f:
+            f.write(output)
+        return 0, wall, rss
+    if not os.path.exists(golden):
+        print(f"{golden}: no golden, so the case is skipped; "
+              "build hyde_record_goldens to create it")
+        return SKIP, wall, rss
+    with open(golden, encoding="utf-8") as f:
+        if f.read() != output:
+            print(f"{golden}: JSON output differs from the golden")
+            return 1, wall, rss
+    return 0, wall, rss
+
+#---------------------------------------------------------------------------------------------------
+
+def check_budget(args, wall, rss):
+    """Holds the run to its baseline. Returns 0 when within budget, 1 when over, None when there
+    is no baseline to hold it to."""
+    baselines = {}
+    if os.path.exists(BASELINES):
+        with open(BASELINES, encoding="utf-8") as f:
+            baselines = json.load(f)
+    key = f"{args.file}/{args.mode}"
+
+    if args.record:
+        baselines[key] = {"wall_seconds": round(wall, 4), "peak_rss_bytes": rss}
+        os.makedirs(GOLDEN_ROOT, exist_ok=True)
+        with open(BASELINES + ".tmp", "w", encoding="utf-8") as f:
+            json.dump(baselines, f, indent=4, sort_keys=True)
+            f.write("\n")
+        os.replace(BASELINES + ".tmp", BASELINES)
+        return 0
+
+    print(f"{key}: {wall:.3f}s, {rss / (1024 * 1024):.1f}MiB")
+
+    if args.threshold is None:
+        return 0
+    if key not in baselines:
+        print(f"{BASELINES}: no baseline for {key}, so its cost is unchecked; "
+              "build hyde_record_goldens to create it")
+        return None
+
+    baseline = baselines[key]
+    limit = 1 + args.threshold
+    status = 0
+    if wall > baseline["wall_seconds"] * limit:
+        print(f"{key}: wall time {wall:.3f}s exceeds the baseline of "
+              f"{baseline['wall_seconds']:.3f}s by more than {args.threshold:.0%}")
+        status = 1
+    if rss > baseline["peak_rss_bytes"] * limit:
+        print(f"{key}: peak RSS {rss} exceeds the baseline of {baseline['peak_rss_bytes']} "
+              f"by more than {args.threshold:.0%}")
+        status = 1
+    return status
+
+#---------------------------------------------------------------------------------------------------
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--hyde", required=True, help="path to the hyde executable")
+    parser.add_argument("--file", required=True, help="the test file, relative to test_files/")
+    parser.add_argument("--mode", required=True, choices=["json", "validate", "update"])
+    parser.add_argument("--hyde-flag", action="append", default=[],
+                        help="an extra flag for hyde (repeatable)")
+    parser.add_argument("--repeat", type=int, default=3, help="runs to take the best time of")
+    parser.add_argument("--threshold", type=float,
+                        help="allowed fractional slowdown or growth over the baseline; "
+                             "performance is not checked without it")
+    parser.add_argument("--record", action="store_true",
+                        help="write the golden and baseline instead of checking them")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory(prefix="hyde_golden_") as scratch:
+        status, wall, rss = check_output(args, scratch)
+
+    if status == SKIP:
+        return SKIP
+
+    print(f"{args.file}/{args.mode}: output check {'failed' if status else 'passed'}")
+
+    # A run that produced the wrong output has no meaningful cost.
+    if status:
+        return status
+
+    # A missing baseline leaves the cost unchecked, which does not undo the output having passed.
+    return 1 if check_budget(args, wall, rss) == 1 else 0
+
+#---------------------------------------------------------------------------------------------------
+
+if __name__ == "__main__":
+    sys.exit(main())